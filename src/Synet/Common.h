@@ -41,6 +41,22 @@
 //#define SYNET_DEBUG_PRINT_ENABLE
 
 #define SYNET_MALLOC_TRIM_THRESHOLD 1024*1024
+
+#ifndef SYNET_CONVOLUTION_TILE_SIZE
+#define SYNET_CONVOLUTION_TILE_SIZE (1024*1024)
+#endif
+
+#ifndef SYNET_POINTWISE_TILE_SIZE
+#define SYNET_POINTWISE_TILE_SIZE 1024
+#endif
+
+#ifndef SYNET_L2_CACHE_SIZE
+#define SYNET_L2_CACHE_SIZE (256*1024)
+#endif
+
+#ifndef SYNET_WEIGHT_ALIGNMENT
+#define SYNET_WEIGHT_ALIGNMENT 64
+#endif
 //#define SYNET_MALLOC_DEBUG
 
 #include <stddef.h>
@@ -73,7 +89,11 @@
 #include <sstream>
 #include <map>
 #include <set>
+#include <list>
 #include <cmath>
+#include <type_traits>
+
+#include "Synet/Utils/ThreadPool.h"
 
 #if defined(SYNET_SIMD_LIBRARY_ENABLE) || defined(SYNET_SIMD_LIBRARY_GEMM_ENABLE)
 #include "Simd/SimdLib.h"
@@ -159,12 +179,13 @@ namespace Synet
 #elif defined(SYNET_OPEN_BLAS_ENABLE)
         return ::openblas_get_num_threads();
 #else
-        return 1;
+        return GlobalThreadPool().Size();
 #endif
     }
 
     inline void SetThreadNumber(size_t threadNumber)
     {
+        GlobalThreadPool().Resize(threadNumber);
 #ifdef SYNET_SIMD_LIBRARY_ENABLE
         ::SimdSetThreadNumber(threadNumber);
 #endif
@@ -174,6 +195,16 @@ namespace Synet
 #endif
     }
 
+    inline size_t GetL2CacheSize()
+    {
+#if defined(__linux__) && defined(_SC_LEVEL2_CACHE_SIZE)
+        long size = ::sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (size > 0)
+            return (size_t)size;
+#endif
+        return SYNET_L2_CACHE_SIZE;
+    }
+
     inline bool GetFlushToZero()
     {
 #if defined(SYNET_SIMD_LIBRARY_ENABLE)
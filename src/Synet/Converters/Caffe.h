@@ -26,6 +26,9 @@
 
 #include "Synet/Common.h"
 #include "Synet/Params.h"
+#include "Synet/Tensor.h"
+#include "Synet/Utils/WeightFile.h"
+#include "Synet/Converters/Optimizer.h"
 
 #if defined(SYNET_CAFFE_ENABLE)
 
@@ -77,6 +80,10 @@ namespace Synet
             if (!ConvertWeight(srcWeight, holder(), weight))
                 return false;
 
+            Optimizer optimizer;
+            if (!optimizer.Run(holder(), weight))
+                return false;
+
             if (!holder.Save(dstModelPath, false))
                 return false;
 
@@ -340,17 +347,7 @@ namespace Synet
 
         bool SaveWeight(const Tensors & weight, const String & path)
         {
-            std::ofstream ofs(path.c_str(), std::ofstream::binary);
-            if (ofs.is_open())
-            {
-                for (size_t i = 0; i < weight.size(); ++i)
-                {
-                    ofs.write((const char*)weight[i].CpuData(), weight[i].Size()*sizeof(float));
-                }
-                ofs.close();
-                return true;
-            }
-            return false;
+            return Synet::SaveWeight(weight, path);
         }
     };
 
@@ -27,6 +27,7 @@
 #include "Synet/Common.h"
 #include "Synet/Params.h"
 #include "Synet/Tensor.h"
+#include "Synet/Utils/WeightFile.h"
 #include "Synet/Converters/Optimizer.h"
 
 #if defined(SYNET_DARKNET_ENABLE)
@@ -105,7 +106,7 @@ namespace Synet
 #endif
 
             Optimizer optimizer;
-            if (!optimizer.Run(holder()))
+            if (!optimizer.Run(holder(), weight))
                 return false;
 
             if (!holder.Save(dstModelPath, false))
@@ -518,17 +519,7 @@ namespace Synet
 
         bool SaveWeight(const Tensors & weight, const String & path)
         {
-            std::ofstream ofs(path.c_str(), std::ofstream::binary);
-            if (ofs.is_open())
-            {
-                for (size_t i = 0; i < weight.size(); ++i)
-                {
-                    ofs.write((const char*)weight[i].CpuData(), weight[i].Size()*sizeof(float));
-                }
-                ofs.close();
-                return true;
-            }
-            return false;
+            return Synet::SaveWeight(weight, path);
         }
 
         String UniqueName(const String & prefix)
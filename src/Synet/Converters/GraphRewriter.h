@@ -0,0 +1,329 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Common.h"
+#include "Synet/Params.h"
+#include "Synet/Tensor.h"
+
+#include <functional>
+
+namespace Synet
+{
+    class GraphRewriter
+    {
+    public:
+        typedef Synet::Tensor<float> Tensor;
+        typedef std::vector<Tensor> Tensors;
+
+        struct Layer
+        {
+            LayerParam param;
+            Tensors weight;
+
+            void AddWeight(const Layer & src, size_t index)
+            {
+                param.weight().push_back(src.param.weight()[index]);
+                weight.push_back(src.weight[index]);
+            }
+        };
+        typedef std::vector<Layer> Layers;
+
+        typedef std::function<bool(const LayerParam & layer)> Predicate;
+
+        struct Node
+        {
+            LayerType type;
+            Ints src;
+            Predicate predicate;
+            bool commutative;
+        };
+
+        struct Match
+        {
+            std::vector<const Layer*> layers;
+            Strings inputs;
+
+            const Layer & operator[](size_t node) const { return *layers[node]; }
+            const Layer & Root() const { return *layers.back(); }
+        };
+
+        typedef std::function<bool(const Match & match, Layers & dst)> Rewrite;
+
+        struct Pattern
+        {
+            String name;
+            std::vector<Node> nodes;
+            Rewrite rewrite;
+
+            Pattern(const String & name_, const Rewrite & rewrite_)
+                : name(name_)
+                , rewrite(rewrite_)
+            {
+            }
+
+            int Add(LayerType type, const Ints & src, const Predicate & predicate = Predicate(), bool commutative = false)
+            {
+                Node node;
+                node.type = type;
+                node.src = src;
+                node.predicate = predicate;
+                node.commutative = commutative;
+                nodes.push_back(node);
+                return (int)nodes.size() - 1;
+            }
+        };
+
+        void Add(const Pattern & pattern)
+        {
+            assert(pattern.nodes.size() && pattern.rewrite);
+            _patterns.push_back(pattern);
+        }
+
+        bool Run(NetworkParam & network, Tensors & weight)
+        {
+            Layers layers;
+            if (!Split(network.layers(), weight, layers))
+                return false;
+            for (bool changed = true; changed;)
+            {
+                changed = false;
+                for (size_t i = 0; i < layers.size() && !changed; ++i)
+                    for (size_t p = 0; p < _patterns.size() && !changed; ++p)
+                        changed = Apply(_patterns[p], i, network.dst(), layers);
+            }
+            Join(layers, network.layers(), weight);
+            return true;
+        }
+
+    private:
+        typedef std::vector<ptrdiff_t> Binding;
+        typedef std::vector<Pattern> Patterns;
+
+        Patterns _patterns;
+
+        static bool Split(const std::vector<LayerParam> & params, const Tensors & weight, Layers & layers)
+        {
+            size_t offset = 0;
+            layers.resize(params.size());
+            for (size_t i = 0; i < params.size(); ++i)
+            {
+                layers[i].param = params[i];
+                size_t count = params[i].weight().size();
+                if (offset + count > weight.size())
+                    return false;
+                layers[i].weight.assign(weight.begin() + offset, weight.begin() + offset + count);
+                offset += count;
+            }
+            return offset == weight.size();
+        }
+
+        static void Join(const Layers & layers, std::vector<LayerParam> & params, Tensors & weight)
+        {
+            params.clear();
+            weight.clear();
+            for (size_t i = 0; i < layers.size(); ++i)
+            {
+                params.push_back(layers[i].param);
+                weight.insert(weight.end(), layers[i].weight.begin(), layers[i].weight.end());
+            }
+        }
+
+        static bool Contains(const Strings & names, const String & name)
+        {
+            return std::find(names.begin(), names.end(), name) != names.end();
+        }
+
+        static ptrdiff_t Producer(const Layers & layers, size_t index, const String & name)
+        {
+            for (ptrdiff_t i = (ptrdiff_t)index - 1; i >= 0; --i)
+                if (Contains(layers[i].param.dst(), name))
+                    return i;
+            return -1;
+        }
+
+        static std::vector<size_t> Consumers(const Layers & layers, size_t index, const String & name)
+        {
+            std::vector<size_t> consumers;
+            for (size_t i = index + 1; i < layers.size(); ++i)
+            {
+                if (Contains(layers[i].param.src(), name))
+                    consumers.push_back(i);
+                if (Contains(layers[i].param.dst(), name))
+                    break;
+            }
+            return consumers;
+        }
+
+        static bool Bound(const Binding & binding, size_t index)
+        {
+            return std::find(binding.begin(), binding.end(), (ptrdiff_t)index) != binding.end();
+        }
+
+        static bool Commutative(const Node & node)
+        {
+            return node.commutative && node.src.size() == 2;
+        }
+
+        static bool Bind(const Pattern & pattern, size_t node, size_t index, const Layers & layers, Binding & binding, Strings & inputs, size_t orders)
+        {
+            if (binding[node] >= 0)
+                return binding[node] == (ptrdiff_t)index;
+            if (Bound(binding, index))
+                return false;
+            const Node & current = pattern.nodes[node];
+            const LayerParam & param = layers[index].param;
+            if (current.type != LayerTypeUnknown && current.type != param.type())
+                return false;
+            if (param.src().size() != current.src.size())
+                return false;
+            if (current.predicate && !current.predicate(param))
+                return false;
+            bool swapped = ((orders >> node) & 1) != 0;
+            binding[node] = index;
+            for (size_t i = 0; i < current.src.size(); ++i)
+            {
+                int src = current.src[swapped ? current.src.size() - 1 - i : i];
+                const String & name = param.src()[i];
+                if (src < 0)
+                {
+                    size_t input = -src - 1;
+                    if (inputs.size() <= input)
+                        inputs.resize(input + 1);
+                    if (inputs[input].empty())
+                        inputs[input] = name;
+                    else if (inputs[input] != name)
+                        return false;
+                }
+                else
+                {
+                    ptrdiff_t producer = Producer(layers, index, name);
+                    if (producer < 0 || !Bind(pattern, src, producer, layers, binding, inputs, orders))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        static bool Isolated(const Binding & binding, const Layers & layers, const Strings & outputs)
+        {
+            size_t root = binding.back(), first = root;
+            for (size_t n = 0; n < binding.size(); ++n)
+                first = std::min(first, (size_t)binding[n]);
+            for (size_t n = 0; n + 1 < binding.size(); ++n)
+            {
+                const LayerParam & param = layers[binding[n]].param;
+                for (size_t i = 0; i < param.dst().size(); ++i)
+                {
+                    if (Contains(outputs, param.dst()[i]))
+                        return false;
+                    std::vector<size_t> consumers = Consumers(layers, binding[n], param.dst()[i]);
+                    for (size_t c = 0; c < consumers.size(); ++c)
+                        if (!Bound(binding, consumers[c]))
+                            return false;
+                }
+            }
+            for (size_t i = first + 1; i < root; ++i)
+            {
+                if (Bound(binding, i))
+                    continue;
+                const Strings & dst = layers[i].param.dst();
+                for (size_t n = 0; n < binding.size(); ++n)
+                {
+                    if ((size_t)binding[n] > i)
+                        continue;
+                    const LayerParam & param = layers[binding[n]].param;
+                    for (size_t j = 0; j < dst.size(); ++j)
+                        if (Contains(param.src(), dst[j]) || Contains(param.dst(), dst[j]))
+                            return false;
+                }
+            }
+            return true;
+        }
+
+        static bool Apply(const Pattern & pattern, size_t root, const Strings & outputs, Layers & layers)
+        {
+            for (size_t orders = 0; orders < ((size_t)1 << pattern.nodes.size()); ++orders)
+            {
+                bool redundant = false;
+                for (size_t n = 0; n < pattern.nodes.size(); ++n)
+                    if (((orders >> n) & 1) && !Commutative(pattern.nodes[n]))
+                        redundant = true;
+                if (!redundant && Apply(pattern, root, outputs, orders, layers))
+                    return true;
+            }
+            return false;
+        }
+
+        static bool Apply(const Pattern & pattern, size_t root, const Strings & outputs, size_t orders, Layers & layers)
+        {
+            Binding binding(pattern.nodes.size(), -1);
+            Match match;
+            if (!Bind(pattern, pattern.nodes.size() - 1, root, layers, binding, match.inputs, orders))
+                return false;
+            for (size_t n = 0; n < binding.size(); ++n)
+                if (binding[n] < 0)
+                    return false;
+            if (!Isolated(binding, layers, outputs))
+                return false;
+            for (size_t n = 0; n < binding.size(); ++n)
+                match.layers.push_back(&layers[binding[n]]);
+            Layers dst;
+            if (!pattern.rewrite(match, dst) || dst.empty())
+                return false;
+            const Strings & old = layers[root].param.dst();
+            Strings & now = dst.back().param.dst();
+            if (now.empty())
+                now = old;
+            if (now.size() != old.size())
+                return false;
+            std::vector<size_t> renamed;
+            for (size_t i = 0; i < old.size(); ++i)
+            {
+                if (now[i] == old[i])
+                    continue;
+                if (Contains(outputs, old[i]))
+                    return false;
+                renamed.push_back(i);
+            }
+            for (size_t r = 0; r < renamed.size(); ++r)
+            {
+                const String & from = old[renamed[r]], & to = now[renamed[r]];
+                std::vector<size_t> consumers = Consumers(layers, root, from);
+                for (size_t c = 0; c < consumers.size(); ++c)
+                {
+                    Strings & src = layers[consumers[c]].param.src();
+                    std::replace(src.begin(), src.end(), from, to);
+                }
+            }
+            std::sort(binding.begin(), binding.end());
+            size_t position = root - (binding.size() - 1);
+            for (size_t n = binding.size(); n > 0; --n)
+                layers.erase(layers.begin() + binding[n - 1]);
+            layers.insert(layers.begin() + position, dst.begin(), dst.end());
+            return true;
+        }
+    };
+}
@@ -26,291 +26,813 @@
 
 #include "Synet/Common.h"
 #include "Synet/Params.h"
+#include "Synet/Converters/GraphRewriter.h"
 
 namespace Synet
 {
     class Optimizer
     {
     public:
+        typedef GraphRewriter::Tensor Tensor;
+        typedef GraphRewriter::Tensors Tensors;
 
-        bool Run(Synet::NetworkParam & network)
+        Optimizer()
         {
-            LayerParams merged;
-            if (!Merge(network.layers(), merged))
+            AddFoldAffine();
+            AddConvolutionAndResidual();
+            AddConvolutionAndActivation();
+            AddFused0();
+            AddFused1();
+            AddFused3();
+            AddPointwise();
+        }
+
+        bool Run(Synet::NetworkParam & network, Tensors & weight)
+        {
+            if (!_rewriter.Run(network, weight))
+                return false;
+
+            if (!ReducePermutes(network))
                 return false;
 
-            network.layers() = merged;
+            if (!_pointwise.Run(network, weight))
+                return false;
 
             return true;
         }
 
     private:
         typedef std::vector<Synet::LayerParam> LayerParams;
-        typedef std::pair<String, String> Change;
-        typedef std::vector<Change> Changes;
+        typedef GraphRewriter::Pattern Pattern;
+        typedef GraphRewriter::Match Match;
+        typedef GraphRewriter::Layer Layer;
+        typedef GraphRewriter::Layers Layers;
+        typedef GraphRewriter::Predicate Predicate;
 
-        bool Merge(const LayerParams & src, LayerParams & dst)
+        GraphRewriter _rewriter, _pointwise;
+
+        void AddFoldAffine()
         {
-            Changes changes;
-            for (size_t i = 0; i < src.size(); ++i)
+            static const LayerType bases[2] = { LayerTypeConvolution, LayerTypeInnerProduct };
+            static const LayerType affines[3] = { LayerTypeBatchNorm, LayerTypeScale, LayerTypeBias };
+            for (size_t i = 0; i < 2; ++i)
             {
-                if (MergeConvolutionAndActivation(src, i, dst, changes))
-                    continue;
-                if (MergeFused0(src, i, dst, changes))
-                    continue;
-                if (MergeFused1(src, i, dst, changes))
-                    continue;
-                if (MergeFused2(src, i, dst, changes))
-                    continue;
-                if (MergeFused3(src, i, dst, changes))
-                    continue;
-                dst.push_back(src[i]);
+                for (size_t j = 0; j < 3; ++j)
+                {
+                    Pattern pattern("FoldAffine", FoldAffine);
+                    int base = pattern.Add(bases[i], Ints({ -1 }), i ? IsFoldableInnerProduct : IsLinearConvolution);
+                    pattern.Add(affines[j], Ints({ base }), IsChannelAffine);
+                    _rewriter.Add(pattern);
+                }
             }
-            for (size_t k = 0; k < changes.size(); ++k)
+        }
+
+        static bool FoldAffine(const Match & match, Layers & dst)
+        {
+            Layer base = match[0];
+            bool conv = base.param.type() == LayerTypeConvolution;
+            size_t channels = conv ? base.param.convolution().outputNum() : base.param.innerProduct().outputNum();
+            Floats scale, shift;
+            if (!ChannelAffine(match.Root(), channels, scale, shift))
+                return false;
+            const Tensor & weight = match[0].weight[0];
+            if (weight.Size() % channels)
+                return false;
+            bool last = conv ? base.param.weight()[0].format() == TensorFormatNhwc : base.param.innerProduct().transposeB();
+            size_t size = weight.Size() / channels;
+            base.weight[0] = Tensor(weight.Shape(), 0.0f, weight.Format());
+            for (size_t i = 0; i < weight.Size(); ++i)
+                base.weight[0].CpuData()[i] = weight.CpuData()[i] * scale[last ? i % channels : i / size];
+            Tensor bias(Shape({ channels }));
+            for (size_t c = 0; c < channels; ++c)
+                bias.CpuData()[c] = shift[c];
+            if (base.weight.size() > 1)
             {
-                for (size_t i = 0; i < dst.size(); ++i)
-                {
-                    for (size_t j = 0; j < dst[i].src().size(); ++j)
-                    {
-                        if (dst[i].src()[j] == changes[k].first)
-                            dst[i].src()[j] = changes[k].second;
-                    }
-                }            
-            }   
+                if (base.weight[1].Size() != channels)
+                    return false;
+                for (size_t c = 0; c < channels; ++c)
+                    bias.CpuData()[c] += base.weight[1].CpuData()[c] * scale[c];
+                base.weight[1] = bias;
+            }
+            else
+            {
+                base.param.weight().push_back(ShapeParam());
+                base.param.weight().back().dim() = bias.Shape();
+                base.weight.push_back(bias);
+                if (conv)
+                    base.param.convolution().biasTerm() = true;
+                else
+                    base.param.innerProduct().biasTerm() = true;
+            }
+            if (base.param.dst() != match.Root().param.dst())
+            {
+                base.param.name() = match.Root().param.name();
+                base.param.dst() = match.Root().param.dst();
+            }
+            dst.push_back(base);
             return true;
         }
 
-        bool MergeConvolutionAndActivation(const LayerParams & src, size_t index, LayerParams & dst, Changes & changes)
+        static bool ChannelAffine(const Layer & layer, size_t channels, Floats & scale, Floats & shift)
         {
-            if (index == 0)
-                return false;
-            if (src[index - 1].type() != LayerTypeConvolution)
-                return false;
-            if (src[index].src().size() != 1 || src[index].src()[0] != src[index - 1].name())
-                return false;
-            for (size_t i = index + 1; i < src.size(); ++i)
+            for (size_t i = 0; i < layer.weight.size(); ++i)
+                if (layer.weight[i].Size() != channels && !(i == 2 && layer.param.type() == LayerTypeBatchNorm))
+                    return false;
+            scale.assign(channels, 1.0f);
+            shift.assign(channels, 0.0f);
+            if (layer.param.type() == LayerTypeBatchNorm)
             {
-                for (size_t j = 0; j < src[i].src().size(); ++j)
+                const BatchNormParam & param = layer.param.batchNorm();
+                const float * mean = layer.weight[0].CpuData(), * variance = layer.weight[1].CpuData();
+                float factor = 1.0f;
+                if (layer.weight.size() > 2)
+                    factor = layer.weight[2].CpuData()[0] == 0.0f ? 0.0f : 1.0f / layer.weight[2].CpuData()[0];
+                for (size_t c = 0; c < channels; ++c)
                 {
-                    if (src[i].src()[j] == src[index - 1].name())
-                        return false;
+                    if (param.yoloCompatible())
+                        scale[c] = 1.0f / (::sqrt(variance[c]) + param.eps());
+                    else
+                        scale[c] = 1.0f / ::sqrt(param.eps() + variance[c] * factor);
+                    shift[c] = -mean[c] * factor * scale[c];
                 }
             }
-            if (src[index].type() == LayerTypeRestrictRange)
+            else if (layer.param.type() == LayerTypeScale)
             {
-                dst.back().convolution().activationType() = ActivationFunctionTypeRestrictRange;
-                dst.back().convolution().activationParam0() = src[index].restrictRange().lower();
-                dst.back().convolution().activationParam1() = src[index].restrictRange().upper();
-                changes.push_back(Change(src[index].name(), src[index - 1].name()));
-                return true;
+                for (size_t c = 0; c < channels; ++c)
+                {
+                    scale[c] = layer.weight[0].CpuData()[c];
+                    if (layer.param.scale().biasTerm())
+                        shift[c] = layer.weight[1].CpuData()[c];
+                }
             }
-            if (src[index].type() == LayerTypeRelu)
+            else if (layer.param.type() == LayerTypeBias)
             {
-                dst.back().convolution().activationType() = src[index].relu().negativeSlope() == 0.0f ? ActivationFunctionTypeRelu : ActivationFunctionTypeLeakyRelu;
-                dst.back().convolution().activationParam0() = src[index].relu().negativeSlope();
-                changes.push_back(Change(src[index].name(), src[index - 1].name()));
-                return true;
+                for (size_t c = 0; c < channels; ++c)
+                    shift[c] = layer.weight[0].CpuData()[c];
             }
-            if (src[index].type() == LayerTypePrelu)
+            else
+                return false;
+            return true;
+        }
+
+        void AddConvolutionAndResidual()
+        {
+            static const LayerType types[2] = { LayerTypeEltwise, LayerTypeShortcut };
+            for (size_t i = 0; i < 2; ++i)
             {
-                dst.back().convolution().activationType() = ActivationFunctionTypePrelu;
-                dst.back().weight().push_back(src[index].weight()[0]);
-                changes.push_back(Change(src[index].name(), src[index - 1].name()));
-                return true;
+                Pattern pattern("ConvolutionAndResidual", MergeConvolutionAndResidual);
+                int conv = pattern.Add(LayerTypeConvolution, Ints({ -1 }), IsLinearConvolution);
+                pattern.Add(types[i], Ints({ conv, -2 }), i ? Predicate() : IsSum, true);
+                _rewriter.Add(pattern);
             }
-            return false;
         }
 
-        bool MergeFused0(const LayerParams & src, size_t & index, LayerParams & dst, Changes & changes)
+        static bool MergeConvolutionAndResidual(const Match & match, Layers & dst)
         {
-            if (index == 0 || src.size() < index + 6)
-                return false;
-            if (src[index - 1].type() != LayerTypeConvolution || !src[index - 1].convolution().biasTerm() || 
-                src[index - 1].convolution().activationType() != ActivationFunctionTypeIdentity)
-                return false;
-            if (src[index + 0].type() != LayerTypeRelu || src[index + 0].src()[0] != src[index - 1].name())
-                return false;
-            if (src[index + 1].type() != LayerTypeUnaryOperation || src[index + 1].unaryOperation().type() != UnaryOperationTypeAbs || 
-                src[index + 1].src()[0] != src[index - 1].name())
-                return false;
-            if (!IsSub(src[index + 2]) || src[index + 2].src() != Strings({ src[index - 1].name(), src[index + 1].name() }))
-                return false;
-            if (src[index + 3].type() != LayerTypeScale || src[index + 3].scale().biasTerm() || src[index + 3].src()[0] != src[index + 2].name())
-                return false;
-            if (src[index + 4].type() != LayerTypeScale || src[index + 4].scale().biasTerm() || src[index + 4].src()[0] != src[index + 3].name())
-                return false;
-            if (src[index + 5].type() != LayerTypeEltwise || src[index + 5].eltwise().operation() != EltwiseOperationTypeSum || 
-                !src[index + 5].eltwise().coefficients().empty() || src[index + 5].src() != Strings({ src[index + 0].name(), src[index + 4].name() }))
-                return false;
-            for (size_t i = index + 6; i < src.size(); ++i)
+            Layer conv = match[0];
+            const LayerParam & sum = match.Root().param;
+            if (match.inputs.size() < 2 || match.inputs[1] == conv.param.dst()[0])
+                return false;
+            conv.param.name() = sum.name();
+            conv.param.src().push_back(match.inputs[1]);
+            conv.param.dst() = sum.dst();
+            conv.param.convolution().residual() = true;
+            dst.push_back(conv);
+            return true;
+        }
+
+        void AddConvolutionAndActivation()
+        {
+            static const LayerType types[3] = { LayerTypeRelu, LayerTypeRestrictRange, LayerTypePrelu };
+            for (size_t i = 0; i < 3; ++i)
             {
-                for (size_t j = 0; j < src[i].src().size(); ++j)
+                for (size_t j = 0; j < 2; ++j)
                 {
-                    for (ptrdiff_t k = -1; k < 5; ++k)
-                    {
-                        if (src[i].src()[j] == src[index + k].name())
-                            return false;
-                    }
+                    Pattern pattern("ConvolutionAndActivation", MergeConvolutionAndActivation);
+                    int conv = pattern.Add(LayerTypeConvolution, j ? Ints({ -1, -2 }) : Ints({ -1 }), j ? IsLinearResidual : IsLinearConvolution);
+                    pattern.Add(types[i], Ints({ conv }));
+                    _rewriter.Add(pattern);
                 }
             }
-            LayerParam layer;
-            layer.type() = LayerTypeFused;
-            layer.name() = src[index + 5].name();
-            layer.src().push_back(src[index - 1].name());
-            layer.dst().push_back(layer.name());
-            layer.fused().type() = 0;
-            layer.weight().push_back(src[index - 1].weight()[1]);
-            layer.weight().push_back(src[index + 3].weight()[0]);
-            layer.weight().push_back(src[index + 4].weight()[0]);
-            dst.back().weight().resize(1);
-            dst.back().convolution().biasTerm() = false;
-            dst.push_back(layer);
-            index += 5;
-            return true;
         }
 
-        bool MergeFused1(const LayerParams & src, size_t & index, LayerParams & dst, Changes & changes)
+        static bool MergeConvolutionAndActivation(const Match & match, Layers & dst)
         {
-            if (index == 0 || src.size() < index + 5)
-                return false;
-            if (src[index - 1].type() != LayerTypeConvolution || !src[index - 1].convolution().biasTerm() ||
-                src[index - 1].convolution().activationType() != ActivationFunctionTypeIdentity)
-                return false;
-            if (src[index + 0].type() != LayerTypeRelu || src[index + 0].src()[0] != src[index - 1].name())
+            const LayerParam & act = match.Root().param;
+            Layer conv = match[0];
+            if (act.type() == LayerTypeRestrictRange)
+            {
+                conv.param.convolution().activationType() = ActivationFunctionTypeRestrictRange;
+                conv.param.convolution().activationParam0() = act.restrictRange().lower();
+                conv.param.convolution().activationParam1() = act.restrictRange().upper();
+            }
+            else if (act.type() == LayerTypeRelu)
+            {
+                conv.param.convolution().activationType() = act.relu().negativeSlope() == 0.0f ? ActivationFunctionTypeRelu : ActivationFunctionTypeLeakyRelu;
+                conv.param.convolution().activationParam0() = act.relu().negativeSlope();
+            }
+            else if (act.type() == LayerTypePrelu)
+            {
+                conv.param.convolution().activationType() = ActivationFunctionTypePrelu;
+                conv.AddWeight(match.Root(), 0);
+            }
+            else
                 return false;
-            if (src[index + 1].type() != LayerTypeScale || src[index + 1].scale().axis() != 0 || !src[index + 1].scale().biasTerm() ||
-                src[index + 1].src()[0] != src[index - 1].name())
+            if (conv.param.dst() != act.dst())
+            {
+                conv.param.name() = act.name();
+                conv.param.dst() = act.dst();
+            }
+            dst.push_back(conv);
+            return true;
+        }
+
+        void AddFused0()
+        {
+            Pattern pattern("Fused0", MergeFused0);
+            int conv = pattern.Add(LayerTypeConvolution, Ints({ -1 }), IsBiasedConvolution);
+            int relu = pattern.Add(LayerTypeRelu, Ints({ conv }));
+            int abs = pattern.Add(LayerTypeUnaryOperation, Ints({ conv }), IsUnary<UnaryOperationTypeAbs>);
+            int sub = pattern.Add(LayerTypeUnknown, Ints({ conv, abs }), IsSub);
+            int scale0 = pattern.Add(LayerTypeScale, Ints({ sub }), IsUnbiasedScale);
+            int scale1 = pattern.Add(LayerTypeScale, Ints({ scale0 }), IsUnbiasedScale);
+            pattern.Add(LayerTypeEltwise, Ints({ relu, scale1 }), IsSum, true);
+            _rewriter.Add(pattern);
+        }
+
+        static bool MergeFused0(const Match & match, Layers & dst)
+        {
+            Layer conv = Unbiased(match[0]), fused = Fused(match, 0);
+            fused.AddWeight(match[0], 1);
+            fused.AddWeight(match[4], 0);
+            fused.AddWeight(match[5], 0);
+            dst.push_back(conv);
+            dst.push_back(fused);
+            return true;
+        }
+
+        void AddFused1()
+        {
+            Pattern pattern("Fused1", MergeFused1);
+            int conv = pattern.Add(LayerTypeConvolution, Ints({ -1 }), IsBiasedConvolution);
+            int relu0 = pattern.Add(LayerTypeRelu, Ints({ conv }));
+            int scale0 = pattern.Add(LayerTypeScale, Ints({ conv }), IsBiasedScaleAxis0);
+            int relu1 = pattern.Add(LayerTypeRelu, Ints({ scale0 }));
+            int scale1 = pattern.Add(LayerTypeScale, Ints({ relu1 }), IsBiasedScale);
+            pattern.Add(LayerTypeEltwise, Ints({ relu0, scale1 }), IsSum, true);
+            _rewriter.Add(pattern);
+        }
+
+        static bool MergeFused1(const Match & match, Layers & dst)
+        {
+            Layer conv = Unbiased(match[0]), fused = Fused(match, 1);
+            fused.AddWeight(match[0], 1);
+            fused.AddWeight(match[2], 0);
+            fused.AddWeight(match[2], 1);
+            fused.AddWeight(match[4], 0);
+            fused.AddWeight(match[4], 1);
+            dst.push_back(conv);
+            dst.push_back(fused);
+            return true;
+        }
+
+        void AddFused3()
+        {
+            static const LayerType types[2] = { LayerTypeConvolution, LayerTypeInnerProduct };
+            for (size_t i = 0; i < 2; ++i)
+            {
+                Pattern pattern("Fused3", MergeFused3);
+                int base = pattern.Add(types[i], Ints({ -1 }), i ? IsBiasedInnerProduct : IsBiasedConvolution);
+                int relu0 = pattern.Add(LayerTypeRelu, Ints({ base }));
+                int neg0 = pattern.Add(LayerTypeUnaryOperation, Ints({ base }), IsUnary<UnaryOperationTypeNeg>);
+                int relu1 = pattern.Add(LayerTypeRelu, Ints({ neg0 }));
+                int neg1 = pattern.Add(LayerTypeUnaryOperation, Ints({ relu1 }), IsUnary<UnaryOperationTypeNeg>);
+                int scale = pattern.Add(LayerTypeScale, Ints({ neg1 }), IsUnbiasedScale);
+                pattern.Add(LayerTypeEltwise, Ints({ relu0, scale }), IsSum, true);
+                _rewriter.Add(pattern);
+            }
+        }
+
+        static bool MergeFused3(const Match & match, Layers & dst)
+        {
+            if (match[0].param.type() == LayerTypeConvolution)
+            {
+                Layer conv = match[0];
+                conv.param.name() = match.Root().param.name();
+                conv.param.dst() = match.Root().param.dst();
+                conv.param.convolution().activationType() = ActivationFunctionTypePrelu;
+                conv.AddWeight(match[5], 0);
+                dst.push_back(conv);
+            }
+            else
+            {
+                Layer product = Unbiased(match[0]), fused = Fused(match, 3);
+                fused.AddWeight(match[0], 1);
+                fused.AddWeight(match[5], 0);
+                dst.push_back(product);
+                dst.push_back(fused);
+            }
+            return true;
+        }
+
+        void AddPointwise()
+        {
+            for (int k = 1; k <= 4; ++k)
+            {
+                Ints src;
+                for (int i = 0; i < k; ++i)
+                    src.push_back(-i - 1);
+                for (size_t j = 0; j < 2; ++j)
+                {
+                    Pattern pattern("Pointwise", MergePointwise);
+                    int first = pattern.Add(LayerTypeUnknown, src, IsPointwise);
+                    pattern.Add(LayerTypeUnknown, j ? Ints({ first, -k - 1 }) : Ints({ first }), IsPointwise, true);
+                    _pointwise.Add(pattern);
+                }
+            }
+            for (size_t j = 0; j < 2; ++j)
+            {
+                Pattern pattern("Pointwise", ConstantToPointwise);
+                int constant = pattern.Add(LayerTypeConst, Ints(), IsScalarConst);
+                pattern.Add(LayerTypeBinaryOperation, j ? Ints({ constant, -1 }) : Ints({ -1, constant }));
+                _pointwise.Add(pattern);
+            }
+        }
+
+        static bool ConstantToPointwise(const Match & match, Layers & dst)
+        {
+            const Layer & constant = match[0], & binary = match.Root();
+            if (constant.weight.size() != 1 || constant.weight[0].Size() != 1 || binary.param.dst().size() != 1)
+                return false;
+            float value = constant.weight[0].CpuData()[0];
+            bool left = binary.param.src()[0] == constant.param.dst()[0];
+            Layer pointwise;
+            pointwise.param.type() = LayerTypePointwise;
+            pointwise.param.name() = binary.param.name();
+            pointwise.param.src().push_back(match.inputs[0]);
+            pointwise.param.dst() = binary.param.dst();
+            std::vector<PointwiseOperationParam> & operations = pointwise.param.pointwise().operations();
+            switch (binary.param.binaryOperation().type())
+            {
+            case BinaryOperationTypeDiv:
+                if (left || value == 0.0f)
+                    return false;
+                operations.resize(1);
+                operations[0].type() = PointwiseOperationTypeScale;
+                operations[0].value() = 1.0f / value;
+                break;
+            case BinaryOperationTypeSub:
+                operations.resize(left ? 2 : 1);
+                if (left)
+                    operations[0].type() = PointwiseOperationTypeNeg;
+                operations.back().type() = PointwiseOperationTypeBias;
+                operations.back().value() = left ? value : -value;
+                break;
+            default:
                 return false;
-            if (src[index + 2].type() != LayerTypeRelu || src[index + 2].src()[0] != src[index + 1].name())
+            }
+            dst.push_back(pointwise);
+            return true;
+        }
+
+        static bool MergePointwise(const Match & match, Layers & dst)
+        {
+            const Layer & first = match[0], & second = match.Root();
+            const Strings & src = second.param.src();
+            const String & link = first.param.dst()[0];
+            if (std::count(src.begin(), src.end(), link) != 1)
                 return false;
-            if (src[index + 3].type() != LayerTypeScale || !src[index + 3].scale().biasTerm() || src[index + 3].src()[0] != src[index + 2].name())
+            Layer pointwise;
+            pointwise.param.type() = LayerTypePointwise;
+            pointwise.param.name() = second.param.name();
+            pointwise.param.dst() = second.param.dst();
+            if (!ToPointwise(first, 0, pointwise))
                 return false;
-            if (src[index + 4].type() != LayerTypeEltwise || src[index + 4].eltwise().operation() != EltwiseOperationTypeSum ||
-                !src[index + 4].eltwise().coefficients().empty() || src[index + 4].src() != Strings({ src[index + 0].name(), src[index + 3].name() }))
+            if (!ToPointwise(second, std::find(src.begin(), src.end(), link) - src.begin(), pointwise))
                 return false;
-            for (size_t i = index + 5; i < src.size(); ++i)
+            dst.push_back(pointwise);
+            return true;
+        }
+
+        static bool ToPointwise(const Layer & layer, size_t chain, Layer & pointwise)
+        {
+            const LayerParam & param = layer.param;
+            Strings & names = pointwise.param.src();
+            std::vector<PointwiseOperationParam> & operations = pointwise.param.pointwise().operations();
+            bool head = names.empty();
+            if (head)
+                names.push_back(param.src()[chain]);
+            Ints src(param.src().size(), -1);
+            for (size_t i = 0; i < src.size(); ++i)
             {
-                for (size_t j = 0; j < src[i].src().size(); ++j)
+                if (i == chain)
+                    src[i] = head ? 0 : -1;
+                else
                 {
-                    for (ptrdiff_t k = -1; k < 4; ++k)
+                    src[i] = int(std::find(names.begin(), names.end(), param.src()[i]) - names.begin());
+                    if (src[i] == (int)names.size())
+                        names.push_back(param.src()[i]);
+                }
+            }
+            struct Add
+            {
+                std::vector<PointwiseOperationParam> & operations;
+                void operator()(PointwiseOperationType type, float value = 0.0f, int src = -1, int weight = -1)
+                {
+                    operations.push_back(PointwiseOperationParam());
+                    operations.back().type() = type;
+                    operations.back().value() = value;
+                    operations.back().src() = src;
+                    operations.back().weight() = weight;
+                }
+            } add = { operations };
+            switch (param.type())
+            {
+            case LayerTypeBias:
+                if (layer.weight.size() != 1 || layer.weight[0].Count() != 1)
+                    return false;
+                pointwise.AddWeight(layer, 0);
+                add(PointwiseOperationTypeBias, 0.0f, -1, (int)pointwise.weight.size() - 1);
+                break;
+            case LayerTypeEltwise:
+            {
+                const EltwiseParam & eltwise = param.eltwise();
+                const Floats & coefficients = eltwise.coefficients();
+                if (coefficients.size() && (eltwise.operation() != EltwiseOperationTypeSum || coefficients.size() != src.size()))
+                    return false;
+                if (coefficients.size() && coefficients[chain] != 1.0f)
+                    add(PointwiseOperationTypeScale, coefficients[chain]);
+                for (size_t i = 0; i < src.size(); ++i)
+                {
+                    float coefficient = coefficients.empty() ? 1.0f : coefficients[i];
+                    if (i == chain)
+                        continue;
+                    if (src[i] < 0)
+                        return false;
+                    switch (eltwise.operation())
+                    {
+                    case EltwiseOperationTypeProduct: add(PointwiseOperationTypeMul, 0.0f, src[i]); break;
+                    case EltwiseOperationTypeSum: add(PointwiseOperationTypeAdd, coefficient, src[i]); break;
+                    case EltwiseOperationTypeMax: add(PointwiseOperationTypeMax, 0.0f, src[i]); break;
+                    case EltwiseOperationTypeMin: add(PointwiseOperationTypeMin, 0.0f, src[i]); break;
+                    default: return false;
+                    }
+                }
+                break;
+            }
+            case LayerTypeLog:
+            {
+                const LogParam & log = param.log();
+                if (log.scale() != 1.0f)
+                    add(PointwiseOperationTypeScale, log.scale());
+                if (log.shift() != 0.0f)
+                    add(PointwiseOperationTypeBias, log.shift());
+                add(PointwiseOperationTypeLog);
+                if (log.base() != -1.0f)
+                    add(PointwiseOperationTypeScale, 1.0f / ::log(log.base()));
+                break;
+            }
+            case LayerTypePointwise:
+                for (size_t i = 0; i < param.pointwise().operations().size(); ++i)
+                {
+                    PointwiseOperationParam operation = param.pointwise().operations()[i];
+                    if (operation.src() >= 0)
                     {
-                        if (src[i].src()[j] == src[index + k].name())
+                        if (src[operation.src()] < 0)
                             return false;
+                        operation.src() = src[operation.src()];
                     }
+                    if (operation.weight() >= 0)
+                        operation.weight() += (int)pointwise.weight.size();
+                    operations.push_back(operation);
+                }
+                for (size_t i = 0; i < layer.weight.size(); ++i)
+                    pointwise.AddWeight(layer, i);
+                break;
+            case LayerTypePrelu:
+                if (layer.weight.size() != 1)
+                    return false;
+                pointwise.AddWeight(layer, 0);
+                add(PointwiseOperationTypePrelu, 0.0f, -1, (int)pointwise.weight.size() - 1);
+                break;
+            case LayerTypeRelu:
+                add(PointwiseOperationTypeRelu, param.relu().negativeSlope());
+                break;
+            case LayerTypeRestrictRange:
+                add(PointwiseOperationTypeMax, param.restrictRange().lower());
+                add(PointwiseOperationTypeMin, param.restrictRange().upper());
+                break;
+            case LayerTypeScale:
+                if (layer.weight.size() != (param.scale().biasTerm() ? 2 : 1))
+                    return false;
+                for (size_t i = 0; i < layer.weight.size(); ++i)
+                {
+                    if (layer.weight[i].Count() != 1)
+                        return false;
+                    pointwise.AddWeight(layer, i);
+                    add(i ? PointwiseOperationTypeBias : PointwiseOperationTypeScale, 0.0f, -1, (int)pointwise.weight.size() - 1);
                 }
+                break;
+            case LayerTypeSigmoid:
+                add(PointwiseOperationTypeSigmoid);
+                break;
+            case LayerTypeUnaryOperation:
+                switch (param.unaryOperation().type())
+                {
+                case UnaryOperationTypeAbs: add(PointwiseOperationTypeAbs); break;
+                case UnaryOperationTypeExp: add(PointwiseOperationTypeExp); break;
+                case UnaryOperationTypeNeg: add(PointwiseOperationTypeNeg); break;
+                case UnaryOperationTypeRsqrt: add(PointwiseOperationTypeRsqrt); break;
+                case UnaryOperationTypeSqrt: add(PointwiseOperationTypeSqrt); break;
+                case UnaryOperationTypeTanh: add(PointwiseOperationTypeTanh); break;
+                default: return false;
+                }
+                break;
+            default:
+                return false;
             }
-            LayerParam layer;
-            layer.type() = LayerTypeFused;
-            layer.name() = src[index + 4].name();
-            layer.src().push_back(src[index - 1].name());
-            layer.dst().push_back(layer.name());
-            layer.fused().type() = 1;
-            layer.weight().push_back(src[index - 1].weight()[1]);
-            layer.weight().push_back(src[index + 1].weight()[0]);
-            layer.weight().push_back(src[index + 1].weight()[1]);
-            layer.weight().push_back(src[index + 3].weight()[0]);
-            layer.weight().push_back(src[index + 3].weight()[1]);
-            dst.back().weight().resize(1);
-            dst.back().convolution().biasTerm() = false;
-            dst.push_back(layer);
-            index += 4;
             return true;
         }
 
-        bool MergeFused2(const LayerParams & src, size_t & index, LayerParams & dst, Changes & changes)
+        static Layer Unbiased(const Layer & src)
         {
-            if (index == 0 || src.size() < index + 2)
-                return false;
-            if (src[index - 1].type() != LayerTypeConvolution || src[index - 1].convolution().biasTerm() ||
-                src[index - 1].convolution().activationType() != ActivationFunctionTypeIdentity)
+            Layer dst = src;
+            dst.param.weight().resize(1);
+            dst.weight.resize(1);
+            if (dst.param.type() == LayerTypeConvolution)
+                dst.param.convolution().biasTerm() = false;
+            else
+                dst.param.innerProduct().biasTerm() = false;
+            return dst;
+        }
+
+        static Layer Fused(const Match & match, int type)
+        {
+            Layer fused;
+            fused.param.type() = LayerTypeFused;
+            fused.param.name() = match.Root().param.name();
+            fused.param.src().push_back(match[0].param.dst()[0]);
+            fused.param.dst() = match.Root().param.dst();
+            fused.param.fused().type() = type;
+            return fused;
+        }
+
+        static bool IsLinearConvolution(const LayerParam & layer)
+        {
+            return layer.convolution().activationType() == ActivationFunctionTypeIdentity;
+        }
+
+        static bool IsLinearResidual(const LayerParam & layer)
+        {
+            return layer.convolution().residual() && layer.convolution().activationType() == ActivationFunctionTypeIdentity;
+        }
+
+        static bool IsBiasedConvolution(const LayerParam & layer)
+        {
+            return layer.convolution().biasTerm() && layer.convolution().activationType() == ActivationFunctionTypeIdentity;
+        }
+
+        static bool IsUnbiasedConvolution(const LayerParam & layer)
+        {
+            return !layer.convolution().biasTerm() && layer.convolution().activationType() == ActivationFunctionTypeIdentity;
+        }
+
+        static bool IsFoldableInnerProduct(const LayerParam & layer)
+        {
+            return layer.innerProduct().axis() == 1;
+        }
+
+        static bool IsChannelAffine(const LayerParam & layer)
+        {
+            switch (layer.type())
+            {
+            case LayerTypeBatchNorm:
+                return layer.batchNorm().useGlobalStats() && layer.weight().size() >= 2;
+            case LayerTypeScale:
+                return layer.scale().axis() == 1 && layer.weight().size() == (layer.scale().biasTerm() ? 2 : 1);
+            case LayerTypeBias:
+                return layer.bias().axis() == 1 && layer.weight().size() == 1;
+            default:
                 return false;
-            if (src[index + 0].type() != LayerTypeBatchNorm || !src[index + 0].batchNorm().useGlobalStats() || !src[index + 0].batchNorm().yoloCompatible() || 
-                src[index + 0].src()[0] != src[index - 1].name() || src[index + 0].dst()[0] != src[index - 1].name())
+            }
+        }
+
+        static bool IsBiasedInnerProduct(const LayerParam & layer)
+        {
+            return layer.innerProduct().biasTerm();
+        }
+
+        template<UnaryOperationType type> static bool IsUnary(const LayerParam & layer)
+        {
+            return layer.unaryOperation().type() == type;
+        }
+
+        static bool IsUnbiasedScale(const LayerParam & layer)
+        {
+            return !layer.scale().biasTerm();
+        }
+
+        static bool IsBiasedScale(const LayerParam & layer)
+        {
+            return layer.scale().biasTerm();
+        }
+
+        static bool IsBiasedScaleAxis0(const LayerParam & layer)
+        {
+            return layer.scale().biasTerm() && layer.scale().axis() == 0;
+        }
+
+        static bool IsBiasedScaleAxis1(const LayerParam & layer)
+        {
+            return layer.scale().biasTerm() && layer.scale().axis() == 1;
+        }
+
+        static bool IsPointwise(const LayerParam & layer)
+        {
+            if (layer.dst().size() != 1)
                 return false;
-            if (src[index + 1].type() != LayerTypeScale || !src[index + 1].scale().biasTerm() || src[index + 1].scale().axis() != 1 ||
-                src[index + 1].src()[0] != src[index - 1].name() || src[index + 1].dst()[0] != src[index - 1].name())
+            switch (layer.type())
+            {
+            case LayerTypeBias:
+                return layer.bias().axis() == 1;
+            case LayerTypeEltwise:
+            case LayerTypeLog:
+            case LayerTypePointwise:
+            case LayerTypePrelu:
+            case LayerTypeRelu:
+            case LayerTypeRestrictRange:
+            case LayerTypeSigmoid:
+                return true;
+            case LayerTypeScale:
+                return layer.scale().axis() == 1;
+            case LayerTypeUnaryOperation:
+                return layer.unaryOperation().type() != UnaryOperationTypeZero;
+            default:
                 return false;
-            if (src[index + 2].type() != LayerTypeRelu || 
-                src[index + 2].src()[0] != src[index - 1].name() || src[index + 2].dst()[0] != src[index - 1].name())
+            }
+        }
+
+        static bool IsScalarConst(const LayerParam & layer)
+        {
+            if (layer.weight().size() != 1)
                 return false;
-            LayerParam layer;
-            layer.type() = LayerTypeFused;
-            layer.name() = src[index + 2].name();
-            layer.src().push_back(src[index - 1].name());
-            layer.dst() = src[index + 2].dst();
-            layer.fused().type() = 2;
-            layer.fused().floats().resize(2);
-            layer.fused().floats()[0] = src[index + 0].batchNorm().eps();
-            layer.fused().floats()[1] = src[index + 2].relu().negativeSlope();
-            layer.weight().push_back(src[index + 0].weight()[0]);
-            layer.weight().push_back(src[index + 0].weight()[1]);
-            layer.weight().push_back(src[index + 1].weight()[0]);
-            layer.weight().push_back(src[index + 1].weight()[1]);
-            dst.push_back(layer);
-            index += 2;
+            const Shape & dim = layer.weight()[0].dim();
+            for (size_t i = 0; i < dim.size(); ++i)
+                if (dim[i] != 1)
+                    return false;
             return true;
         }
 
-        bool MergeFused3(const LayerParams & src, size_t & index, LayerParams & dst, Changes & changes)
+        static bool IsSum(const LayerParam & layer)
         {
-            if (index == 0 || src.size() < index + 6)
-                return false;
-            if ((src[index - 1].type() != LayerTypeConvolution || !src[index - 1].convolution().biasTerm() || 
-                src[index - 1].convolution().activationType() != ActivationFunctionTypeIdentity) &&
-                (src[index - 1].type() != LayerTypeInnerProduct || !src[index - 1].innerProduct().biasTerm()))
-                return false;
-            if (src[index + 0].type() != LayerTypeRelu || src[index + 0].src()[0] != src[index - 1].name())
-                return false;
-            if (src[index + 1].type() != LayerTypeUnaryOperation || src[index + 1].unaryOperation().type() != UnaryOperationTypeNeg ||
-                src[index + 1].src()[0] != src[index - 1].name())
-                return false;
-            if (src[index + 2].type() != LayerTypeRelu || src[index + 2].src()[0] != src[index + 1].name())
-                return false;
-            if (src[index + 3].type() != LayerTypeUnaryOperation || src[index + 3].unaryOperation().type() != UnaryOperationTypeNeg ||
-                src[index + 3].src()[0] != src[index + 2].name())
-                return false;
-            if (src[index + 4].type() != LayerTypeScale || src[index + 4].scale().biasTerm() || src[index + 4].src()[0] != src[index + 3].name())
-                return false;
-            if (src[index + 5].type() != LayerTypeEltwise || src[index + 5].eltwise().operation() != EltwiseOperationTypeSum ||
-                !src[index + 5].eltwise().coefficients().empty() || src[index + 5].src() != Strings({ src[index + 0].name(), src[index + 4].name() }))
-                return false;
-            for (size_t i = index + 6; i < src.size(); ++i)
+            return layer.eltwise().operation() == EltwiseOperationTypeSum && layer.eltwise().coefficients().empty();
+        }
+
+        bool ReducePermutes(Synet::NetworkParam & network)
+        {
+            LayerParams & layers = network.layers();
+            for (bool changed = true; changed;)
             {
-                for (size_t j = 0; j < src[i].src().size(); ++j)
+                changed = false;
+                for (size_t i = 0; i < layers.size() && !changed; ++i)
                 {
-                    for (ptrdiff_t k = -1; k < 5; ++k)
-                    {
-                        if (src[i].src()[j] == src[index + k].name())
-                            return false;
-                    }
+                    if (layers[i].type() != LayerTypePermute || layers[i].src().size() != 1 || layers[i].dst().size() != 1 || 
+                        std::find(network.dst().begin(), network.dst().end(), layers[i].dst()[0]) != network.dst().end())
+                        continue;
+                    changed = RemovePermute(layers, i) || MergePermutes(layers, i, network.dst()) || SinkPermute(layers, i, network.dst());
                 }
             }
-            if (dst.back().type() == LayerTypeConvolution)
+            return true;
+        }
+
+        bool RemovePermute(LayerParams & layers, size_t index)
+        {
+            const LayerParam & permute = layers[index];
+            const Shape & order = permute.permute().order();
+            for (size_t i = 0; i < order.size(); ++i)
+                if (order[i] != i)
+                    return false;
+            if (permute.permute().format() != TensorFormatUnknown)
+                return false;
+            String src = permute.src()[0], dst = permute.dst()[0];
+            for (size_t i = 0; i < layers.size(); ++i)
+                if (i != index && std::find(layers[i].dst().begin(), layers[i].dst().end(), dst) != layers[i].dst().end())
+                    return false;
+            for (size_t i = index + 1; i < layers.size(); ++i)
+                for (size_t j = 0; j < layers[i].src().size(); ++j)
+                    if (layers[i].src()[j] == dst)
+                        layers[i].src()[j] = src;
+            layers.erase(layers.begin() + index);
+            return true;
+        }
+
+        bool MergePermutes(LayerParams & layers, size_t index, const Strings & outputs)
+        {
+            LayerParam & second = layers[index];
+            ptrdiff_t prev = Producer(layers, index, second.src()[0]);
+            if (prev < 0 || !IsSinglePermute(layers, prev, index, outputs))
+                return false;
+            const LayerParam & first = layers[prev];
+            if (first.permute().order().size() != second.permute().order().size())
+                return false;
+            Shape order;
+            for (size_t i = 0; i < second.permute().order().size(); ++i)
+                order.push_back(first.permute().order()[second.permute().order()[i]]);
+            second.src() = first.src();
+            second.permute().order() = order;
+            if (second.permute().format() == TensorFormatUnknown)
+                second.permute().format() = first.permute().format();
+            layers.erase(layers.begin() + prev);
+            return true;
+        }
+
+        bool SinkPermute(LayerParams & layers, size_t index, const Strings & outputs)
+        {
+            std::vector<size_t> consumers = Consumers(layers, index, layers[index].dst()[0]);
+            if (consumers.size() != 1)
+                return false;
+            size_t next = consumers[0];
+            LayerParam layer = layers[next];
+            const Shape & order = layers[index].permute().order();
+            switch (layer.type())
             {
-                dst.back().name() = src[index + 5].name();
-                dst.back().dst().back() = dst.back().name();
-                dst.back().convolution().activationType() = ActivationFunctionTypePrelu;
-                dst.back().weight().push_back(src[index + 4].weight()[0]);
+            case LayerTypeRelu:
+            case LayerTypeSigmoid:
+            case LayerTypeRestrictRange:
+            case LayerTypeUnaryOperation:
+            case LayerTypeLog:
+            case LayerTypeEltwise:
+                break;
+            case LayerTypeConcat:
+                if (layer.concat().axis() >= order.size())
+                    return false;
+                layer.concat().axis() = (uint32_t)order[layer.concat().axis()];
+                break;
+            case LayerTypeSoftmax:
+                if (layer.softmax().axis() >= order.size())
+                    return false;
+                layer.softmax().axis() = (uint32_t)order[layer.softmax().axis()];
+                break;
+            default:
+                return false;
             }
-            else
+            if (layer.dst().size() != 1 || (layer.src().size() > 1 && layer.src()[0] == layer.dst()[0]))
+                return false;
+            std::vector<size_t> permutes;
+            for (size_t i = 0; i < layer.src().size(); ++i)
             {
-                LayerParam layer;
-                layer.type() = LayerTypeFused;
-                layer.name() = src[index + 5].name();
-                layer.src().push_back(src[index - 1].name());
-                layer.dst().push_back(layer.name());
-                layer.fused().type() = 3;
-                layer.weight().push_back(src[index - 1].weight()[1]);
-                layer.weight().push_back(src[index + 4].weight()[0]);
-                dst.back().weight().resize(1);
-                dst.back().innerProduct().biasTerm() = false;
-                dst.push_back(layer);
+                ptrdiff_t prev = Producer(layers, next, layer.src()[i]);
+                if (prev < 0 || !IsSinglePermute(layers, prev, next, outputs) || 
+                    layers[prev].permute().order() != order || layers[prev].permute().format() != layers[index].permute().format())
+                    return false;
+                layer.src()[i] = layers[prev].src()[0];
+                permutes.push_back(prev);
             }
-            index += 5;
+            LayerParam permute = layers[index];
+            permute.src()[0] = layers[index].src()[0] + "_" + layer.name();
+            permute.dst() = layer.dst();
+            layer.dst()[0] = permute.src()[0];
+            layers[next] = layer;
+            layers.insert(layers.begin() + next + 1, permute);
+            std::sort(permutes.begin(), permutes.end());
+            for (size_t i = permutes.size(); i > 0; --i)
+                layers.erase(layers.begin() + permutes[i - 1]);
             return true;
         }
 
-        bool IsSub(const LayerParam & layer)
+        bool IsSinglePermute(const LayerParams & layers, size_t index, size_t consumer, const Strings & outputs)
+        {
+            const LayerParam & layer = layers[index];
+            if (layer.type() != LayerTypePermute || layer.src().size() != 1 || layer.dst().size() != 1)
+                return false;
+            if (std::find(outputs.begin(), outputs.end(), layer.dst()[0]) != outputs.end())
+                return false;
+            std::vector<size_t> consumers = Consumers(layers, index, layer.dst()[0]);
+            return consumers.size() == 1 && consumers[0] == consumer;
+        }
+
+        ptrdiff_t Producer(const LayerParams & layers, size_t index, const String & name)
+        {
+            for (ptrdiff_t i = (ptrdiff_t)index - 1; i >= 0; --i)
+                if (std::find(layers[i].dst().begin(), layers[i].dst().end(), name) != layers[i].dst().end())
+                    return i;
+            return -1;
+        }
+
+        std::vector<size_t> Consumers(const LayerParams & layers, size_t index, const String & name)
+        {
+            std::vector<size_t> consumers;
+            for (size_t i = index + 1; i < layers.size(); ++i)
+            {
+                if (std::find(layers[i].src().begin(), layers[i].src().end(), name) != layers[i].src().end())
+                    consumers.push_back(i);
+                if (std::find(layers[i].dst().begin(), layers[i].dst().end(), name) != layers[i].dst().end())
+                    break;
+            }
+            return consumers;
+        }
+
+        static bool IsSub(const LayerParam & layer)
         {
             if (layer.type() == LayerTypeEltwise && layer.eltwise().operation() == EltwiseOperationTypeSum && layer.eltwise().coefficients() == Floats({ 1.0f, -1.0f }))
                 return true;
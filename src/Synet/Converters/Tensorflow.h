@@ -25,6 +25,7 @@
 #pragma once
 
 #include "Synet/Network.h"
+#include "Synet/Utils/WeightFile.h"
 #include "Synet/Converters/Optimizer.h"
 
 #if defined(SYNET_TENSORFLOW_ENABLE)
@@ -108,7 +109,7 @@ namespace Synet
                 return false;
 
             Optimizer optimizer;
-            if (!optimizer.Run(holder()))
+            if (!optimizer.Run(holder(), weight))
                 return false;
 
             if (!holder.Save(dstModelPath, false))
@@ -1706,17 +1707,7 @@ namespace Synet
 
         bool SaveWeight(const Tensors & weight, const String & path)
         {
-            std::ofstream ofs(path.c_str(), std::ofstream::binary);
-            if (ofs.is_open())
-            {
-                for (size_t i = 0; i < weight.size(); ++i)
-                {
-                    ofs.write((const char*)weight[i].CpuData(), weight[i].Size()*sizeof(float));
-                }
-                ofs.close();
-                return true;
-            }
-            return false;
+            return Synet::SaveWeight(weight, path);
         }
     };
 
@@ -38,12 +38,17 @@ namespace Synet
         typedef std::vector<Tensor> Tensors;
         typedef std::vector<Tensor*> TensorPtrs;
 
+        struct Cache
+        {
+            std::mutex mutex;
+            std::map<String, Tensor> tensors;
+        };
+        typedef std::shared_ptr<Cache> CachePtr;
+
         Layer(const LayerParam & param)
             : _param(param)
         {
             _weight.resize(_param.weight().size());
-            for (size_t i = 0; i < _weight.size(); ++i)
-                _weight[i].Reshape(_param.weight()[i].dim(), Type(), _param.weight()[i].format());
         }
 
         virtual ~Layer()
@@ -67,10 +72,50 @@ namespace Synet
 
         virtual void Reshape(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst) = 0;
 
+        virtual bool RowWindow(size_t & /*kernel*/, size_t & /*stride*/, size_t & /*pad*/) const
+        {
+            return false;
+        }
+
+        virtual void ForwardRows(const TensorPtrs & /*src*/, const TensorPtrs & /*buf*/, const TensorPtrs & /*dst*/, size_t /*dstY0*/, size_t /*dstY1*/)
+        {
+            assert(0);
+        }
+
+        virtual void Compile(LayerParam & /*param*/, Tensors & /*state*/) const
+        {
+        }
+
+        virtual size_t MemoryUsage() const
+        {
+            return 0;
+        }
+
+        void SetState(const Tensors & state)
+        {
+            _state = state;
+        }
+
+        void SetCache(const CachePtr & cache)
+        {
+            _cache = cache;
+        }
+
+        void Share(const Tensors & weight)
+        {
+            assert(weight.size() == _weight.size());
+            for (size_t i = 0; i < _weight.size(); ++i)
+            {
+                assert(weight[i].Shape() == _param.weight()[i].dim());
+                _weight[i].Share(weight[i]);
+            }
+        }
+
         bool Load(const void * & data, size_t & size)
         {
             for (size_t i = 0; i < _weight.size(); ++i)
             {
+                _weight[i].Reshape(_param.weight()[i].dim(), Type(), _param.weight()[i].format());
                 size_t requred = _weight[i].Size() * sizeof(Type);
                 if (requred > size)
                     return false;
@@ -84,15 +129,54 @@ namespace Synet
         bool Load(std::istream & is)
         {
             for (size_t i = 0; i < _weight.size(); ++i)
+            {
+                _weight[i].Reshape(_param.weight()[i].dim(), Type(), _param.weight()[i].format());
                 is.read((char*)_weight[i].CpuData(), _weight[i].Size() * sizeof(T));
+            }
             return true;
         }
 
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst) = 0;
 
+        bool Restore(size_t index, const Shape & shape, Tensor & tensor) const
+        {
+            if (index < _state.size() && _state[index].Shape() == shape)
+            {
+                tensor.Share(_state[index]);
+                return true;
+            }
+            tensor = Tensor();
+            return false;
+        }
+
+        bool Cached(const String & name, const Shape & shape, Tensor & tensor) const
+        {
+            if (_cache)
+            {
+                std::lock_guard<std::mutex> lock(_cache->mutex);
+                typename std::map<String, Tensor>::const_iterator it = _cache->tensors.find(name);
+                if (it != _cache->tensors.end() && it->second.Shape() == shape)
+                {
+                    tensor.Share(it->second);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void Store(const String & name, const Tensor & tensor) const
+        {
+            if (_cache)
+            {
+                std::lock_guard<std::mutex> lock(_cache->mutex);
+                _cache->tensors[name].Share(tensor);
+            }
+        }
+
     private:
         const LayerParam & _param;
-        Tensors _weight;
+        Tensors _weight, _state;
+        CachePtr _cache;
     };
 }
\ No newline at end of file
@@ -52,19 +52,20 @@ namespace Synet
             _eps = param.eps();
             _useGlobalStats = param.useGlobalStats();
             _yoloCompatible = param.yoloCompatible();
+            _block = TensorFormatBlock(src[0]->Format());
+            assert(_block == 1 || _useGlobalStats);
             if (src[0]->Count() == 1)
                 _channels = 1;
             else
-                _channels = src[0]->Axis(1);            
-            
-            if (src[0]->Count() >= 1)
-                assert(src[0]->Axis(1) == _channels);
+                _channels = src[0]->Axis(1) * _block;
             dst[0]->Reshape(src[0]->Shape(), Type(), src[0]->Format());
-            if (_useGlobalStats)
+            if (_useGlobalStats && !(this->Restore(0, Shape({ _channels }), _scale) && this->Restore(1, Shape({ _channels }), _bias)))
             {
                 Type scaleFactor = Type(1);
                 if(this->Weight().size() > 2)
                     scaleFactor = this->Weight()[2].CpuData()[0] == 0 ? Type(0) : Type(1) / this->Weight()[2].CpuData()[0];
+                _scale = Tensor();
+                _bias = Tensor();
                 _scale.Reshape({ _channels });
                 _bias.Reshape({ _channels });
                 for (size_t i = 0; i < _channels; ++i)
@@ -76,7 +77,7 @@ namespace Synet
                     _bias.CpuData()[i] = -this->Weight()[0].CpuData()[i] * scaleFactor * _scale.CpuData()[i];
                 }
             }
-            else
+            else if (!_useGlobalStats)
             {
                 _mean.Reshape({ _channels });
                 _variance.Reshape({ _channels });
@@ -99,6 +100,21 @@ namespace Synet
             }
         }
 
+        virtual void Compile(LayerParam & /*param*/, Tensors & state) const
+        {
+            if (_useGlobalStats)
+            {
+                state.push_back(_scale);
+                state.push_back(_bias);
+            }
+        }
+
+        virtual size_t MemoryUsage() const
+        {
+            return (_mean.Size() + _variance.Size() + _temp.Size() + _batchSumMultiplier.Size() + _numByChans.Size() + 
+                _spatialSumMultiplier.Size() + _scale.Size() + _bias.Size()) * sizeof(Type);
+        }
+
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
@@ -114,7 +130,13 @@ namespace Synet
                 size_t size = src[0]->Size(1);
                 for (size_t i = 0; i < num; ++i)
                 {
-                    Detail::ScaleLayerForwardCpu(pSrc, _scale.CpuData(), _bias.CpuData(), _channels, spatialDim, pDst, src[0]->Format() == TensorFormatNhwc);
+                    if (_block > 1)
+                    {
+                        for (size_t c = 0; c < _channels; c += _block)
+                            Detail::ScaleLayerForwardCpu(pSrc + c * spatialDim, _scale.CpuData() + c, _bias.CpuData() + c, _block, spatialDim, pDst + c * spatialDim, 1);
+                    }
+                    else
+                        Detail::ScaleLayerForwardCpu(pSrc, _scale.CpuData(), _bias.CpuData(), _channels, spatialDim, pDst, src[0]->Format() == TensorFormatNhwc);
                     pSrc += size;
                     pDst += size;
                 }
@@ -150,7 +172,7 @@ namespace Synet
         }
 
     private:
-        size_t _channels;
+        size_t _channels, _block;
         bool _useGlobalStats, _yoloCompatible;
         Type _movingAverageFraction, _eps;
         Tensor _mean, _variance, _temp;
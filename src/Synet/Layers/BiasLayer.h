@@ -77,7 +77,9 @@ namespace Synet
             _axis = param.axis();
             const Tensor & bias = (src.size() > 1 ? *src[1] : this->Weight()[0]);
             _trans = src[0]->Format() == TensorFormatNhwc;
+            _block = TensorFormatBlock(src[0]->Format());
             _count = bias.Size();
+            assert(_block == 1 || _count % _block == 0);
             if (bias.Size() == src[0]->Size())
             {
                 _num = 1;
@@ -102,14 +104,20 @@ namespace Synet
             Type * pDst = dst[0]->CpuData();
             for (size_t n = 0; n < _num; ++n)
             {
-                Detail::BiasLayerForwardCpu(pSrc, pBias, _count, _size, pDst, _trans);
+                if (_block > 1)
+                {
+                    for (size_t c = 0; c < _count; c += _block)
+                        Detail::BiasLayerForwardCpu(pSrc + c * _size, pBias + c, _block, _size, pDst + c * _size, 1);
+                }
+                else
+                    Detail::BiasLayerForwardCpu(pSrc, pBias, _count, _size, pDst, _trans);
                 pSrc += _count*_size;
                 pDst += _count*_size;
             }
         }
 
     private:
-        size_t _axis, _num, _count, _size;
+        size_t _axis, _num, _count, _size, _block;
         int _trans;
     };
 }
\ No newline at end of file
@@ -27,6 +27,7 @@
 #include "Synet/Common.h"
 #include "Synet/Layer.h"
 #include "Synet/Utils/Math.h"
+#include "Synet/Layers/ReorderLayer.h"
 
 namespace Synet
 {
@@ -42,9 +43,37 @@ namespace Synet
         {
         }
 
+        bool Mixed() const
+        {
+            return _mixed;
+        }
+
+        bool Contiguous() const
+        {
+            return !_mixed && _concatNum == 1;
+        }
+
         virtual void Reshape(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
             _concatAxis = this->Param().concat().axis();
+            _mixed = false;
+            for (size_t i = 1; i < src.size(); ++i)
+                if (src[i]->Format() != src[0]->Format())
+                    _mixed = true;
+            if (_mixed)
+            {
+                assert(_concatAxis == 1);
+                Shape dstShape({ src[0]->Axis(0), 0, src[0]->Axis(2), src[0]->Axis(3) });
+                for (size_t i = 0; i < src.size(); ++i)
+                {
+                    assert(src[i]->Axis(0) == dstShape[0] && src[i]->Axis(2) == dstShape[2] && src[i]->Axis(3) == dstShape[3]);
+                    dstShape[1] += src[i]->Size(1) / dstShape[2] / dstShape[3];
+                }
+                _concatNum = dstShape[0];
+                _concatInputSize = dstShape[2] * dstShape[3];
+                dst[0]->Reshape(dstShape, Type(), TensorFormatNchw);
+                return;
+            }
             _concatNum = src[0]->Size(0, _concatAxis);
             _concatInputSize = src[0]->Size(_concatAxis + 1);
             size_t srcSizeSum = src[0]->Size();
@@ -77,19 +106,43 @@ namespace Synet
 
             Type * dstData = dst[0]->CpuData();
             size_t concatAxisOffset = 0;
+            if (_mixed)
+            {
+                size_t dstChannels = dst[0]->Axis(1);
+                for (size_t i = 0; i < src.size(); ++i)
+                {
+                    const Type * srcData = src[i]->CpuData();
+                    size_t block = TensorFormatBlock(src[i]->Format()), channels = src[i]->Size(1) / _concatInputSize;
+                    for (size_t n = 0; n < _concatNum; ++n)
+                    {
+                        const Type * ps = srcData + n * channels * _concatInputSize;
+                        Type * pd = dstData + (n * dstChannels + concatAxisOffset) * _concatInputSize;
+                        if (block > 1)
+                            Detail::ReorderBlockedToNchw(ps, channels, _concatInputSize, block, pd);
+                        else
+                            CpuCopy(ps, channels * _concatInputSize, pd);
+                    }
+                    concatAxisOffset += channels;
+                }
+                return;
+            }
             size_t dstConcatAxis = dst[0]->Axis(_concatAxis);
             for (size_t i = 0; i < src.size(); ++i)
             {
                 const Type * srcData = src[i]->CpuData();
                 size_t srcConcatAxis = src[i]->Axis(_concatAxis);
-                for (size_t n = 0; n < _concatNum; ++n)
-                    CpuCopy(srcData + n * srcConcatAxis * _concatInputSize, srcConcatAxis * _concatInputSize, 
-                        dstData + (n * dstConcatAxis + concatAxisOffset) * _concatInputSize);
+                if (srcData != dstData + concatAxisOffset * _concatInputSize)
+                {
+                    for (size_t n = 0; n < _concatNum; ++n)
+                        CpuCopy(srcData + n * srcConcatAxis * _concatInputSize, srcConcatAxis * _concatInputSize,
+                            dstData + (n * dstConcatAxis + concatAxisOffset) * _concatInputSize);
+                }
                 concatAxisOffset += srcConcatAxis;
             }
         }
 
     private:
         size_t _concatNum, _concatInputSize, _concatAxis;
+        bool _mixed;
     };
 }
\ No newline at end of file
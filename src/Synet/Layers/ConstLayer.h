@@ -38,18 +38,33 @@ namespace Synet
 
         ConstLayer(const LayerParam & param)
             : Base(param)
+            , _writable(false)
         {
         }
 
+        void SetWritable(bool writable)
+        {
+            _writable = writable;
+        }
+
         virtual void Reshape(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
             assert(this->Weight().size() == 1 && dst.size() == 1);
-            dst[0]->Share(this->Weight()[0]);
+            const Tensor<Type> & weight = this->Weight()[0];
+            if (_writable)
+                dst[0]->Reshape(weight.Shape(), Type(), weight.Format());
+            else
+                dst[0]->Share(weight);
         }
 
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
+            if (_writable)
+                CpuCopy(this->Weight()[0].CpuData(), this->Weight()[0].Size(), dst[0]->CpuData());
         }
+
+    private:
+        bool _writable;
     };
 }
\ No newline at end of file
@@ -30,10 +30,397 @@
 #include "Synet/Utils/ImgToCol.h"
 #include "Synet/Utils/Winograd.h"
 #include "Synet/Utils/Convolution.h"
+#include "Synet/Utils/ConvolutionTuner.h"
 #include "Synet/Layers/PreluLayer.h"
 
 namespace Synet
 {
+    namespace Detail
+    {
+        template <class T> void ConvolutionForwardDirect(const T * src, size_t srcC, size_t srcH, size_t srcW, int trans, const T * weight, 
+            size_t kernelY, size_t kernelX, size_t dilationY, size_t dilationX, size_t strideY, size_t strideX, size_t padY, size_t padX, 
+            size_t group, T * dst, size_t dstC, size_t dstH, size_t dstW)
+        {
+            size_t srcG = srcC / group, dstG = dstC / group;
+            if (trans)
+            {
+                ParallelFor(0, dstH, 1, [=](size_t begin, size_t end)
+                {
+                    for (size_t dy = begin; dy < end; ++dy)
+                    {
+                        for (size_t dx = 0; dx < dstW; ++dx)
+                        {
+                            T * pd = dst + (dy * dstW + dx) * dstC;
+                            for (size_t dc = 0; dc < dstC; ++dc)
+                                pd[dc] = T(0);
+                            for (size_t ky = 0; ky < kernelY; ++ky)
+                            {
+                                size_t sy = dy * strideY + ky * dilationY - padY;
+                                if (sy >= srcH)
+                                    continue;
+                                for (size_t kx = 0; kx < kernelX; ++kx)
+                                {
+                                    size_t sx = dx * strideX + kx * dilationX - padX;
+                                    if (sx >= srcW)
+                                        continue;
+                                    const T * ps = src + (sy * srcW + sx) * srcC;
+                                    const T * pw = weight + (ky * kernelX + kx) * srcG * dstC;
+                                    for (size_t g = 0; g < group; ++g)
+                                    {
+                                        for (size_t sc = 0; sc < srcG; ++sc)
+                                        {
+                                            T value = ps[g * srcG + sc];
+                                            const T * w = pw + sc * dstC + g * dstG;
+                                            T * d = pd + g * dstG;
+                                            for (size_t dc = 0; dc < dstG; ++dc)
+                                                d[dc] += value * w[dc];
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                });
+            }
+            else
+            {
+                ParallelFor(0, dstC, 1, [=](size_t begin, size_t end)
+                {
+                    for (size_t dc = begin; dc < end; ++dc)
+                    {
+                        size_t g = dc / dstG;
+                        T * pd = dst + dc * dstH * dstW;
+                        for (size_t i = 0; i < dstH * dstW; ++i)
+                            pd[i] = T(0);
+                        for (size_t sc = 0; sc < srcG; ++sc)
+                        {
+                            const T * ps = src + (g * srcG + sc) * srcH * srcW;
+                            for (size_t ky = 0; ky < kernelY; ++ky)
+                            {
+                                for (size_t kx = 0; kx < kernelX; ++kx)
+                                {
+                                    T w = weight[((dc * srcG + sc) * kernelY + ky) * kernelX + kx];
+                                    ptrdiff_t offset = kx * dilationX - padX;
+                                    size_t dxB = offset < 0 ? (strideX - 1 - offset) / strideX : 0;
+                                    size_t dxE = std::min<ptrdiff_t>(dstW, std::max<ptrdiff_t>(0, srcW - offset + strideX - 1) / strideX);
+                                    for (size_t dy = 0; dy < dstH; ++dy)
+                                    {
+                                        size_t sy = dy * strideY + ky * dilationY - padY;
+                                        if (sy >= srcH)
+                                            continue;
+                                        const T * s = ps + sy * srcW + offset;
+                                        T * d = pd + dy * dstW;
+                                        for (size_t dx = dxB; dx < dxE; ++dx)
+                                            d[dx] += w * s[dx * strideX];
+                                    }
+                                }
+                            }
+                        }
+                    }
+                });
+            }
+        }
+
+        template <class T> SYNET_INLINE void ConvolutionActivate(T * dst, size_t size, ActivationFunctionType activation, T param0, T param1, const T * slope)
+        {
+            switch (activation)
+            {
+            case ActivationFunctionTypeIdentity:
+                break;
+            case ActivationFunctionTypeRelu:
+                for (size_t i = 0; i < size; ++i)
+                    dst[i] = std::max(dst[i], T(0));
+                break;
+            case ActivationFunctionTypeLeakyRelu:
+                for (size_t i = 0; i < size; ++i)
+                    dst[i] = CpuRelu(dst[i], param0);
+                break;
+            case ActivationFunctionTypeRestrictRange:
+                for (size_t i = 0; i < size; ++i)
+                    dst[i] = std::min(std::max(param0, dst[i]), param1);
+                break;
+            case ActivationFunctionTypePrelu:
+                for (size_t i = 0; i < size; ++i)
+                    dst[i] = CpuRelu(dst[i], slope[i]);
+                break;
+            default:
+                assert(0);
+            }
+        }
+
+        template <class T, size_t kernel, size_t stride> void ConvolutionDepthwiseNchwMain(const T * src, size_t srcW, 
+            size_t dilationY, size_t dilationX, const T * weight, T bias, size_t dxB, size_t dxE, T * dst)
+        {
+            for (size_t dx = dxB; dx < dxE; ++dx)
+            {
+                T sum = bias;
+                for (size_t ky = 0; ky < kernel; ++ky)
+                    for (size_t kx = 0; kx < kernel; ++kx)
+                        sum += weight[ky * kernel + kx] * src[ky * dilationY * srcW + dx * stride + kx * dilationX];
+                dst[dx] = sum;
+            }
+        }
+
+        template <class T> void ConvolutionDepthwiseNchwMain(const T * src, size_t srcW, size_t kernelY, size_t kernelX, 
+            size_t strideX, size_t dilationY, size_t dilationX, const T * weight, T bias, size_t dxB, size_t dxE, T * dst)
+        {
+            for (size_t dx = dxB; dx < dxE; ++dx)
+            {
+                T sum = bias;
+                for (size_t ky = 0; ky < kernelY; ++ky)
+                    for (size_t kx = 0; kx < kernelX; ++kx)
+                        sum += weight[ky * kernelX + kx] * src[ky * dilationY * srcW + dx * strideX + kx * dilationX];
+                dst[dx] = sum;
+            }
+        }
+
+        template <class T> void ConvolutionDepthwiseNchw(const T * src, size_t channels, size_t srcH, size_t srcW, const T * weight, const T * bias,
+            size_t kernelY, size_t kernelX, size_t dilationY, size_t dilationX, size_t strideY, size_t strideX, size_t padY, size_t padX,
+            ActivationFunctionType activation, const T * params, T * dst, size_t dstH, size_t dstW)
+        {
+            typedef void(*MainPtr)(const T *, size_t, size_t, size_t, const T *, T, size_t, size_t, T *);
+            MainPtr main = NULL;
+            if (kernelY == kernelX && strideY == strideX)
+            {
+                if (kernelY == 3 && strideX == 1)
+                    main = ConvolutionDepthwiseNchwMain<T, 3, 1>;
+                if (kernelY == 3 && strideX == 2)
+                    main = ConvolutionDepthwiseNchwMain<T, 3, 2>;
+                if (kernelY == 5 && strideX == 1)
+                    main = ConvolutionDepthwiseNchwMain<T, 5, 1>;
+                if (kernelY == 5 && strideX == 2)
+                    main = ConvolutionDepthwiseNchwMain<T, 5, 2>;
+            }
+            size_t extY = (kernelY - 1) * dilationY + 1, extX = (kernelX - 1) * dilationX + 1;
+            size_t dyB = std::min((padY + strideY - 1) / strideY, dstH);
+            size_t dyE = srcH + padY >= extY ? std::max(std::min((srcH + padY - extY) / strideY + 1, dstH), dyB) : dyB;
+            size_t dxB = std::min((padX + strideX - 1) / strideX, dstW);
+            size_t dxE = srcW + padX >= extX ? std::max(std::min((srcW + padX - extX) / strideX + 1, dstW), dxB) : dxB;
+            ParallelFor(0, channels, 1, [=](size_t begin, size_t end)
+            {
+                for (size_t c = begin; c < end; ++c)
+                {
+                    const T * ps = src + c * srcH * srcW;
+                    const T * pw = weight + c * kernelY * kernelX;
+                    T * pd = dst + c * dstH * dstW;
+                    T value = bias ? bias[c] : T(0);
+                    T param0 = activation == ActivationFunctionTypePrelu ? params[c] : params[0];
+                    for (size_t dy = 0; dy < dstH; ++dy, pd += dstW)
+                    {
+                        bool inside = dy >= dyB && dy < dyE;
+                        for (size_t dx = 0; dx < dstW; ++dx)
+                        {
+                            if (inside && dx == dxB)
+                            {
+                                const T * pm = ps + (dy * strideY - padY) * srcW - padX;
+                                if (main)
+                                    main(pm, srcW, dilationY, dilationX, pw, value, dxB, dxE, pd);
+                                else
+                                    ConvolutionDepthwiseNchwMain(pm, srcW, kernelY, kernelX, strideX, dilationY, dilationX, pw, value, dxB, dxE, pd);
+                                dx = dxE;
+                                if (dx == dstW)
+                                    break;
+                            }
+                            T sum = value;
+                            for (size_t ky = 0; ky < kernelY; ++ky)
+                            {
+                                size_t sy = dy * strideY + ky * dilationY - padY;
+                                if (sy >= srcH)
+                                    continue;
+                                for (size_t kx = 0; kx < kernelX; ++kx)
+                                {
+                                    size_t sx = dx * strideX + kx * dilationX - padX;
+                                    if (sx < srcW)
+                                        sum += pw[ky * kernelX + kx] * ps[sy * srcW + sx];
+                                }
+                            }
+                            pd[dx] = sum;
+                        }
+                        ConvolutionActivate(pd, dstW, activation == ActivationFunctionTypePrelu ? ActivationFunctionTypeLeakyRelu : activation, param0, params[1], params);
+                    }
+                }
+            });
+        }
+
+        template <class T> void ConvolutionDepthwiseNhwc(const T * src, size_t channels, size_t srcH, size_t srcW, const T * weight, const T * bias,
+            size_t kernelY, size_t kernelX, size_t dilationY, size_t dilationX, size_t strideY, size_t strideX, size_t padY, size_t padX,
+            ActivationFunctionType activation, const T * params, T * dst, size_t dstW, size_t dstY0, size_t dstY1)
+        {
+            ParallelFor(dstY0, dstY1, 1, [=](size_t begin, size_t end)
+            {
+                for (size_t dy = begin; dy < end; ++dy)
+                {
+                    for (size_t dx = 0; dx < dstW; ++dx)
+                    {
+                        T * pd = dst + (dy * dstW + dx) * channels;
+                        for (size_t c = 0; c < channels; ++c)
+                            pd[c] = bias ? bias[c] : T(0);
+                        for (size_t ky = 0; ky < kernelY; ++ky)
+                        {
+                            size_t sy = dy * strideY + ky * dilationY - padY;
+                            if (sy >= srcH)
+                                continue;
+                            for (size_t kx = 0; kx < kernelX; ++kx)
+                            {
+                                size_t sx = dx * strideX + kx * dilationX - padX;
+                                if (sx >= srcW)
+                                    continue;
+                                const T * ps = src + (sy * srcW + sx) * channels;
+                                const T * pw = weight + (ky * kernelX + kx) * channels;
+                                for (size_t c = 0; c < channels; ++c)
+                                    pd[c] += ps[c] * pw[c];
+                            }
+                        }
+                        ConvolutionActivate(pd, channels, activation, params[0], params[1], params);
+                    }
+                }
+            });
+        }
+
+        template <class T, size_t B, size_t N> struct ConvolutionBlockedPixels
+        {
+            static SYNET_INLINE void Run(const T * src, size_t srcC, size_t srcH, size_t srcW, size_t srcB, const T * weight, size_t kernelY, size_t kernelX, 
+                size_t dilationY, size_t dilationX, size_t strideY, size_t strideX, size_t padY, size_t padX, size_t dy, size_t dx, T sum[][B])
+            {
+                size_t srcS = srcH * srcW * srcB, step = strideX * srcB;
+                for (size_t ky = 0; ky < kernelY; ++ky)
+                {
+                    size_t sy = dy * strideY + ky * dilationY - padY;
+                    if (sy >= srcH)
+                        continue;
+                    for (size_t kx = 0; kx < kernelX; ++kx)
+                    {
+                        size_t sx = dx * strideX + kx * dilationX - padX;
+                        if (N == 1 && sx >= srcW)
+                            continue;
+                        const T * pw = weight + (ky * kernelX + kx) * srcC * B;
+                        const T * ps = src + (sy * srcW + sx) * srcB;
+                        for (size_t cb = 0; cb < srcC; cb += srcB, ps += srcS)
+                        {
+                            for (size_t ci = 0; ci < srcB; ++ci, pw += B)
+                            {
+                                for (size_t n = 0; n < N; ++n)
+                                {
+                                    T s = ps[n * step + ci];
+                                    for (size_t b = 0; b < B; ++b)
+                                        sum[n][b] += s * pw[b];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        };
+
+#if defined(SYNET_GEMM_AVX512) || defined(SYNET_GEMM_AVX) || defined(SYNET_GEMM_SSE)
+        template <size_t B, size_t N> struct ConvolutionBlockedPixelsVector
+        {
+            typedef GemmVector V;
+            static const size_t K = B / V::F;
+
+            static SYNET_INLINE void Run(const float * src, size_t srcC, size_t srcH, size_t srcW, size_t srcB, const float * weight, size_t kernelY, size_t kernelX,
+                size_t dilationY, size_t dilationX, size_t strideY, size_t strideX, size_t padY, size_t padX, size_t dy, size_t dx, float sum[][B])
+            {
+                V::Type acc[N][K];
+                for (size_t n = 0; n < N; ++n)
+                    for (size_t k = 0; k < K; ++k)
+                        acc[n][k] = V::Load(sum[n] + k * V::F);
+                size_t srcS = srcH * srcW * srcB, step = strideX * srcB;
+                for (size_t ky = 0; ky < kernelY; ++ky)
+                {
+                    size_t sy = dy * strideY + ky * dilationY - padY;
+                    if (sy >= srcH)
+                        continue;
+                    for (size_t kx = 0; kx < kernelX; ++kx)
+                    {
+                        size_t sx = dx * strideX + kx * dilationX - padX;
+                        if (N == 1 && sx >= srcW)
+                            continue;
+                        const float * pw = weight + (ky * kernelX + kx) * srcC * B;
+                        const float * ps = src + (sy * srcW + sx) * srcB;
+                        for (size_t cb = 0; cb < srcC; cb += srcB, ps += srcS)
+                        {
+                            for (size_t ci = 0; ci < srcB; ++ci, pw += B)
+                            {
+                                V::Type w[K];
+                                for (size_t k = 0; k < K; ++k)
+                                    w[k] = V::Load(pw + k * V::F);
+                                for (size_t n = 0; n < N; ++n)
+                                {
+                                    V::Type s = V::Set(ps[n * step + ci]);
+                                    for (size_t k = 0; k < K; ++k)
+                                        acc[n][k] = V::Fmadd(s, w[k], acc[n][k]);
+                                }
+                            }
+                        }
+                    }
+                }
+                for (size_t n = 0; n < N; ++n)
+                    for (size_t k = 0; k < K; ++k)
+                        V::Store(sum[n] + k * V::F, acc[n][k]);
+            }
+        };
+
+        template <size_t N> struct ConvolutionBlockedPixels<float, 16, N> : public ConvolutionBlockedPixelsVector<16, N>
+        {
+        };
+
+#if !defined(SYNET_GEMM_AVX512)
+        template <size_t N> struct ConvolutionBlockedPixels<float, 8, N> : public ConvolutionBlockedPixelsVector<8, N>
+        {
+        };
+#endif
+#endif
+
+        template <class T, size_t B> void ConvolutionForwardBlocked(const T * src, size_t srcC, size_t srcH, size_t srcW, size_t srcB, const T * weight, const T * bias,
+            size_t kernelY, size_t kernelX, size_t dilationY, size_t dilationX, size_t strideY, size_t strideX, size_t padY, size_t padX,
+            ActivationFunctionType activation, const T * params, T * dst, size_t dstC, size_t dstH, size_t dstW, size_t dstB)
+        {
+            const size_t N = 6;
+            size_t dstCB = (dstC + B - 1) / B, dstS = dstH * dstW;
+            size_t dxB = std::min((padX + strideX - 1) / strideX, dstW), dxE = dxB;
+            if (srcW + padX >= dilationX * (kernelX - 1) + 1)
+                dxE = std::max(std::min((srcW + padX - dilationX * (kernelX - 1) - 1) / strideX + 1, dstW), dxB);
+            ParallelFor(0, dstCB * dstH, 1, [=](size_t begin, size_t end)
+            {
+                T sum[N][B];
+                for (size_t i = begin; i < end; ++i)
+                {
+                    size_t db = i / dstH, dy = i % dstH, tail = std::min(B, dstC - db * B);
+                    const T * pw = weight + db * kernelY * kernelX * srcC * B;
+                    const T * slope = activation == ActivationFunctionTypePrelu ? params + db * B : params;
+                    for (size_t dx = 0; dx < dstW;)
+                    {
+                        size_t n = dx >= dxB && dx + N <= dxE ? N : 1;
+                        for (size_t j = 0; j < n; ++j)
+                            for (size_t b = 0; b < B; ++b)
+                                sum[j][b] = bias[db * B + b];
+                        if (n == N)
+                            ConvolutionBlockedPixels<T, B, N>::Run(src, srcC, srcH, srcW, srcB, pw, kernelY, kernelX, dilationY, dilationX, strideY, strideX, padY, padX, dy, dx, sum);
+                        else
+                            ConvolutionBlockedPixels<T, B, 1>::Run(src, srcC, srcH, srcW, srcB, pw, kernelY, kernelX, dilationY, dilationX, strideY, strideX, padY, padX, dy, dx, sum);
+                        for (size_t j = 0; j < n; ++j, ++dx)
+                        {
+                            ConvolutionActivate(sum[j], B, activation, params[0], params[1], slope);
+                            if (dstB > 1)
+                            {
+                                T * pd = dst + db * dstS * B + (dy * dstW + dx) * B;
+                                for (size_t b = 0; b < B; ++b)
+                                    pd[b] = sum[j][b];
+                            }
+                            else
+                            {
+                                T * pd = dst + db * B * dstS + dy * dstW + dx;
+                                for (size_t b = 0; b < tail; ++b)
+                                    pd[b * dstS] = sum[j][b];
+                            }
+                        }
+                    }
+                }
+            });
+        }
+    }
+
     template <class T> class ConvolutionLayer : public Synet::Layer<T>
     {
     public:
@@ -77,7 +464,6 @@ namespace Synet
             _padX = pad.size() > 1 ? pad[1] : _padY;
             _padH = pad.size() > 2 ? pad[2] : _padY;
             _padW = pad.size() > 3 ? pad[3] : _padX;
-            assert(_padY >= 0 && _padX >= 0 && _padH >= 0 && _padW >= 0);
 
             _is1x1 = _kernelY == 1 && _kernelX == 1 && _strideY == 1 && _strideX == 1 && _dilationY == 1 && _dilationX == 1 && _padY == 0 && _padX == 0 && _padH == 0 && _padW == 0;
 
@@ -105,10 +491,15 @@ namespace Synet
             }
 
             _axis = param.axis();
-            assert(src[0]->Count() == _axis + 3);
+            _residual = param.residual();
+            assert(!_residual || (src.size() == 2 && dst.size() == 1));
+            _srcBlock = TensorFormatBlock(src[0]->Format());
+            assert(src[0]->Count() == _axis + (_srcBlock > 1 ? 4 : 3));
 
             _num = src[0]->Size(0, _axis);
             _trans = src[0]->Format() == TensorFormatNhwc;
+            if (_trans && _group != 1)
+                _is1x1 = false;
             if (_trans)
             {
                 _srcH = src[0]->Axis(-3);
@@ -117,6 +508,14 @@ namespace Synet
 
                 assert(weight[0].Shape() == Shape({ _kernelY, _kernelX, _srcC / _group, _dstC }) && weight[0].Format() == TensorFormatNhwc);
             }
+            else if (_srcBlock > 1)
+            {
+                _srcC = src[0]->Axis(-4) * _srcBlock;
+                _srcH = src[0]->Axis(-3);
+                _srcW = src[0]->Axis(-2);
+
+                assert(weight[0].Shape() == Shape({ _dstC, _srcC / _group, _kernelY, _kernelX }) && weight[0].Format() == TensorFormatNchw);
+            }
             else
             {
                 _srcC = src[0]->Axis(-3);
@@ -129,8 +528,32 @@ namespace Synet
             _dstH = (_srcH + _padY + _padH - (_dilationY * (_kernelY - 1) + 1)) / _strideY + 1;
             _dstW = (_srcW + _padX + _padW - (_dilationX * (_kernelX - 1) + 1)) / _strideX + 1;
 
+            _dstBlock = TensorFormatBlock(param.format());
+            if (_group > 1 && _group == _srcC && _group == _dstC)
+                _dstBlock = _srcBlock;
+            if (_trans || _dstC % _dstBlock)
+                _dstBlock = 1;
+            _block = std::max(_srcBlock, _dstBlock);
+            assert(_block == 1 || _group == 1 || _srcBlock == _dstBlock);
+
             Shape dstShape(src[0]->Shape().begin(), src[0]->Shape().begin() + _axis);
-            if (_trans)
+            TensorFormat dstFormat = src[0]->Format();
+            if (_dstBlock > 1)
+            {
+                dstShape.push_back(_dstC / _dstBlock);
+                dstShape.push_back(_dstH);
+                dstShape.push_back(_dstW);
+                dstShape.push_back(_dstBlock);
+                dstFormat = _dstBlock == 16 ? TensorFormatNchw16c : TensorFormatNchw8c;
+            }
+            else if (_srcBlock > 1)
+            {
+                dstShape.push_back(_dstC);
+                dstShape.push_back(_dstH);
+                dstShape.push_back(_dstW);
+                dstFormat = TensorFormatNchw;
+            }
+            else if (_trans)
             {
                 dstShape.push_back(_dstH);
                 dstShape.push_back(_dstW);
@@ -168,23 +591,89 @@ namespace Synet
             }
 
             for (size_t i = 0; i < dst.size(); ++i)
-                dst[i]->Reshape(dstShape, Type(), src[0]->Format());
+                dst[i]->Reshape(dstShape, Type(), dstFormat);
+            assert(!_residual || (src[1]->Shape() == dstShape && src[1]->Format() == dstFormat));
 
             _srcSize = src[0]->Size(_axis);
             _dstSize = dst[0]->Size(_axis);
 
-            _convolution.Init(_srcC, _srcH, _srcW, _trans, _dstC, _trans, _kernelY, _kernelX, _dilationY, _dilationX, _strideY, _strideX, _padY, _padX, _padH, _padW, _group, _activation);
-            if (_convolution.Enable())
+            _algorithm = param.algorithm();
+            if (_algorithm == ConvolutionAlgorithmTypeAuto && _block == 1 && GlobalConvolutionTuner().Enable())
+                _algorithm = Tune();
+            buf[0]->Extend(Shape({ Prepare() }));
+            if (param.algorithm() == ConvolutionAlgorithmTypeWinograd && _algorithm != ConvolutionAlgorithmTypeWinograd)
+                std::cout << "Convolution layer '" << this->Param().name() << "' can't use Winograd, ImgToCol is used instead!" << std::endl;
+        }
+
+        virtual void Compile(LayerParam & param, Tensors & state) const
+        {
+            if (param.convolution().algorithm() == ConvolutionAlgorithmTypeAuto)
+                param.convolution().algorithm() = _algorithm;
+            if (_block > 1)
             {
-                buf[0]->Extend({ _convolution.BufferSize() });
-                int internal;
-                _convolution.SetParams(weight[0].CpuData(), _trans, &internal, _biasTerm ? weight[1].CpuData() : NULL, 
-                    _activation == ActivationFunctionTypePrelu ? weight.back().CpuData() : _params);
-                if (internal && 0)
-                    const_cast<Tensor&>(weight[0]).Clear();
+                state.push_back(_blockedWeight);
+                state.push_back(_blockedBias);
+                if (_blockedSlope.Size())
+                    state.push_back(_blockedSlope);
+            }
+            else if (_algorithm == ConvolutionAlgorithmTypeWinograd)
+                _winograd.Export(state);
+            else if (_algorithm == ConvolutionAlgorithmTypeImgToCol && _packed.Size())
+                state.push_back(_packed);
+        }
+
+        virtual size_t MemoryUsage() const
+        {
+            return _convolution.Enable() ? this->Weight()[0].Size() * sizeof(Type) : 0;
+        }
+
+        bool StridedDst(size_t axis) const
+        {
+            if (_axis != 1 || _dstBlock > 1)
+                return false;
+            if (_trans)
+                return axis == 3 && _block == 1 && _algorithm == ConvolutionAlgorithmTypeImgToCol;
+            return axis == 1;
+        }
+
+        bool InPlaceResidual() const
+        {
+            return _residual && _block == 1 && !_depthwise && _algorithm == ConvolutionAlgorithmTypeImgToCol;
+        }
+
+        virtual bool RowWindow(size_t & kernel, size_t & stride, size_t & pad) const
+        {
+            kernel = _dilationY * (_kernelY - 1) + 1;
+            stride = _strideY;
+            pad = _padY;
+            return _trans && _block == 1 && _num == 1 && (_depthwise || _algorithm == ConvolutionAlgorithmTypeImgToCol);
+        }
+
+        virtual void ForwardRows(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst, size_t dstY0, size_t dstY1)
+        {
+            SYNET_PERF_FUNC();
+            const Type * sum = _residual ? src[1]->CpuData() : NULL;
+            Type * pDst = dst[0]->CpuData();
+            size_t offset = dstY0 * _dstW * _dstC, size = (dstY1 - dstY0) * _dstW;
+            _ldD = _dstC;
+            if (_depthwise)
+            {
+                const Tensors & weight = this->Weight();
+                const Type * params = _activation == ActivationFunctionTypePrelu ? weight.back().CpuData() : _params;
+                Detail::ConvolutionDepthwiseNhwc(src[0]->CpuData(), _srcC, _srcH, _srcW, weight[0].CpuData(), _biasTerm ? weight[1].CpuData() : NULL, 
+                    _kernelY, _kernelX, _dilationY, _dilationX, _strideY, _strideX, _padY, _padX, sum ? ActivationFunctionTypeIdentity : _activation, 
+                    params, pDst, _dstW, dstY0, dstY1);
+                if (sum)
+                {
+                    CpuAdd(sum + offset, pDst + offset, size * _dstC, pDst + offset);
+                    ForwardActivation(pDst + offset, size, false);
+                }
             }
             else
-                buf[0]->Extend(Shape({ _kernelY*_kernelX*_srcC, _dstH*_dstW }));
+            {
+                ForwardGemm(src[0]->CpuData(), buf[0]->CpuData(), this->Weight()[0].CpuData(), sum, pDst, dstY0, dstY1);
+                ForwardActivation(pDst + offset, size);
+            }
         }
 
     protected:
@@ -192,12 +681,17 @@ namespace Synet
         {
             SYNET_PERF_FUNC();
 
-            for (int i = 0; i < src.size(); ++i)
-                for (int n = 0; n < this->_num; ++n)
-                    ForwardCpu(src[i]->CpuData() + _srcSize * n, buf[0]->CpuData(), dst[i]->CpuData() + _dstSize * n);
+            for (size_t i = 0; i < dst.size(); ++i)
+            {
+                size_t dstStride = dst[i]->Dense() ? _dstSize : dst[i]->Stride(0);
+                if (_trans && _block == 1)
+                    _ldD = dst[i]->Dense() ? _dstC : dst[i]->Stride(-2);
+                for (size_t n = 0; n < this->_num; ++n)
+                    ForwardCpu(src[i]->CpuData() + _srcSize * n, buf[0]->CpuData(), _residual ? src[1]->CpuData() + _dstSize * n : NULL, dst[i]->CpuData() + dstStride * n);
+            }
         }
 
-        void ForwardCpu(const T * src, T * buf, T * dst)
+        void ForwardCpu(const T * src, T * buf, const T * sum, T * dst)
         {
 #ifdef SYNET_SIZE_STATISTIC
             std::stringstream ss;
@@ -208,61 +702,371 @@ namespace Synet
 #endif
             if (_convolution.Enable())
                 _convolution.Forward(src, buf, dst);
-            else
+            else if (_block > 1 || _depthwise)
             {
-                const Type * weight = this->Weight()[0].CpuData();
-                if (!_is1x1)
+                ActivationFunctionType activation = sum ? ActivationFunctionTypeIdentity : _activation;
+                if (_block > 1)
+                    ForwardBlocked(src, activation, dst);
+                else
                 {
+                    const Tensors & weight = this->Weight();
+                    const Type * bias = _biasTerm ? weight[1].CpuData() : NULL;
+                    const Type * params = _activation == ActivationFunctionTypePrelu ? weight.back().CpuData() : _params;
                     if (_trans)
-                        Synet::ImgToRow(src, _srcH, _srcW, _srcC, _kernelY, _kernelX, _padY, _padX, _padH, _padW, _strideY, _strideX, _dilationY, _dilationX, _group, buf);
+                        Detail::ConvolutionDepthwiseNhwc(src, _srcC, _srcH, _srcW, weight[0].CpuData(), bias, _kernelY, _kernelX, _dilationY, _dilationX,
+                            _strideY, _strideX, _padY, _padX, activation, params, dst, _dstW, 0, _dstH);
                     else
-                        Synet::ImgToCol(src, _srcC, _srcH, _srcW, _kernelY, _kernelX, _padY, _padX, _padH, _padW, _strideY, _strideX, _dilationY, _dilationX, buf);
-                    src = buf;
+                        Detail::ConvolutionDepthwiseNchw(src, _srcC, _srcH, _srcW, weight[0].CpuData(), bias, _kernelY, _kernelX, _dilationY, _dilationX,
+                            _strideY, _strideX, _padY, _padX, activation, params, dst, _dstH, _dstW);
+                }
+                if (sum)
+                {
+                    CpuAdd(sum, dst, _dstSize, dst);
+                    ForwardActivation(dst, _dstH * _dstW, false);
                 }
+            }
+            else
+            {
+                const Type * weight = this->Weight()[0].CpuData();
+                if (_algorithm == ConvolutionAlgorithmTypeWinograd)
+                    _winograd.Convolution(src, buf, buf + _winograd.SrcBufSize(), dst);
+                else if (_algorithm == ConvolutionAlgorithmTypeDirect)
+                    Detail::ConvolutionForwardDirect(src, _srcC, _srcH, _srcW, _trans, weight, _kernelY, _kernelX, _dilationY, _dilationX,
+                        _strideY, _strideX, _padY, _padX, _group, dst, _dstC, _dstH, _dstW);
+                else
+                    ForwardGemm(src, buf, weight, sum, dst, 0, _dstH);
+                if (sum && _algorithm != ConvolutionAlgorithmTypeImgToCol)
+                    CpuAdd(sum, dst, _dstSize, dst);
+                if (_trans && _ldD != _dstC)
+                {
+                    for (size_t i = 0, size = _dstH * _dstW; i < size; ++i)
+                        ForwardActivation(dst + i * _ldD, 1);
+                }
+                else
+                    ForwardActivation(dst, _dstH * _dstW);
+            }
+        }
+
+        void ForwardActivation(T * dst, size_t size, bool bias = true)
+        {
+            if (_biasTerm && bias)
+                CpuAddBias(this->Weight()[1].CpuData(), _dstC, size, dst, _trans);
+            switch (_activation)
+            {
+            case ActivationFunctionTypeIdentity:
+                break;
+            case ActivationFunctionTypeRelu:
+                CpuRelu(dst, _dstC * size, 0.0f, dst);
+                break;
+            case ActivationFunctionTypeLeakyRelu:
+                CpuRelu(dst, _dstC * size, _params[0], dst);
+                break;
+            case ActivationFunctionTypeRestrictRange:
+                CpuRestrictRange(dst, _dstC * size, _params[0], _params[1], dst);
+                break;
+            case ActivationFunctionTypePrelu:
+                if (_dstBlock > 1)
+                {
+                    for (size_t c = 0; c < _dstC; c += _dstBlock)
+                        Detail::PreluLayerForwardCpu(dst + c * size, _blockedSlope.CpuData() + c, _dstBlock, size, dst + c * size, 1);
+                }
+                else
+                    Detail::PreluLayerForwardCpu(dst, this->Weight().back().CpuData(), _dstC, size, dst, _trans);
+                break;
+            default:
+                assert(0);
+            }
+        }
+
+        void ForwardBlocked(const T * src, ActivationFunctionType activation, T * dst)
+        {
+            const Type * weight = _blockedWeight.CpuData();
+            const Type * bias = _blockedBias.CpuData();
+            const Type * params = activation == ActivationFunctionTypePrelu ? _blockedSlope.CpuData() : _params;
+            if (_depthwise)
+            {
+                size_t srcS = _srcH * _srcW * _block, dstS = _dstH * _dstW * _block, step = activation == ActivationFunctionTypePrelu ? _block : 0;
+                for (size_t cb = 0, size = _kernelY * _kernelX * _block; cb < _srcC / _block; ++cb)
+                    Detail::ConvolutionDepthwiseNhwc(src + cb * srcS, _block, _srcH, _srcW, weight + cb * size, bias + cb * _block, _kernelY, _kernelX, 
+                        _dilationY, _dilationX, _strideY, _strideX, _padY, _padX, activation, params + cb * step, dst + cb * dstS, _dstW, 0, _dstH);
+            }
+            else if (_block == 16)
+                Detail::ConvolutionForwardBlocked<Type, 16>(src, _srcC, _srcH, _srcW, _srcBlock, weight, bias, _kernelY, _kernelX, _dilationY, _dilationX, 
+                    _strideY, _strideX, _padY, _padX, activation, params, dst, _dstC, _dstH, _dstW, _dstBlock);
+            else
+                Detail::ConvolutionForwardBlocked<Type, 8>(src, _srcC, _srcH, _srcW, _srcBlock, weight, bias, _kernelY, _kernelX, _dilationY, _dilationX,
+                    _strideY, _strideX, _padY, _padX, activation, params, dst, _dstC, _dstH, _dstW, _dstBlock);
+        }
+
+        void ForwardGemm(const T * src, T * buf, const T * weight, const T * sum, T * dst, size_t dstY0, size_t dstY1)
+        {
+            Type beta = sum ? Type(1) : Type(0);
+            if (_is1x1)
+            {
+                size_t begin = dstY0 * _dstW, size = (dstY1 - dstY0) * _dstW;
+                if (sum)
+                    Preload(sum, begin, begin + size, dst);
+                ForwardGemm(src + begin * (_trans ? _ldS : 1), size, _ldS, _grS, weight, beta, dst + begin * (_trans ? _ldD : 1));
+                return;
+            }
+            for (size_t dy = dstY0; dy < dstY1; dy += _tileH)
+            {
+                size_t dyE = std::min(dy + _tileH, dstY1), size = (dyE - dy) * _dstW;
+                if (sum)
+                    Preload(sum, dy * _dstW, dyE * _dstW, dst);
                 if (_trans)
                 {
-                    assert(_group == 1 || _group == _srcC);
+                    Synet::ImgToRow(src, _srcH, _srcW, _srcC, _kernelY, _kernelX, _padY, _padX, _padW, _strideY, _strideX, _dilationY, _dilationX, _group, dy, dyE, buf);
+                    ForwardGemm(buf, size, _siW, size * _siW, weight, beta, dst + dy * _dstW * _ldD);
+                }
+                else
+                {
+                    Synet::ImgToCol(src, _srcC, _srcH, _srcW, _kernelY, _kernelX, _padY, _padX, _padH, _padW, _strideY, _strideX, _dilationY, _dilationX, dy, dyE, buf);
+                    ForwardGemm(buf, size, size, size * _siW, weight, beta, dst + dy * _dstW);
+                }
+            }
+        }
+
+        void Preload(const T * sum, size_t begin, size_t end, T * dst)
+        {
+            if (sum == dst)
+                return;
+            if (_trans)
+            {
+                for (size_t i = begin; i < end; ++i)
+                    memcpy(dst + i * _ldD, sum + i * _dstC, _dstC * sizeof(T));
+            }
+            else
+            {
+                for (size_t c = 0, size = _dstH * _dstW; c < _dstC; ++c)
+                    memcpy(dst + c * size + begin, sum + c * size + begin, (end - begin) * sizeof(T));
+            }
+        }
+
+        void ForwardGemm(const T * src, size_t siS, size_t ldS, size_t grS, const T * weight, T beta, T * dst)
+        {
+            if (_trans)
+            {
+                assert(_group == 1 || _group == _srcC);
+                if (_packed.Size())
+                    CpuGemmPackedB(CblasNoTrans, siS, _siD, _siW, Type(1), src, ldS, _packed.CpuData(), beta, dst, _ldD);
+                else
+                {
+                    for (size_t g = 0; g < _group; ++g)
+                        CpuGemm(CblasNoTrans, CblasNoTrans, siS, _siD, _siW, Type(1), src + grS * g, ldS, weight + _grW * g, _ldW, beta, dst + _grD * g, _ldD);
+                }
+            }
+            else
+            {
+                if (_packed.Size())
+                {
+                    size_t size = _packed.Size() / _group;
                     for (size_t g = 0; g < _group; ++g)
-                        CpuGemm(CblasNoTrans, CblasNoTrans, _siS, _siD, _siW, Type(1), src + _grS * g, _ldS, weight + _grW * g, _ldW, Type(0), dst + _grD * g, _ldD);
+                        CpuGemmPackedA(CblasNoTrans, _siD, siS, _siW, Type(1), _packed.CpuData() + size * g, src + grS * g, ldS, beta, dst + _grD * g, _ldD);
                 }
                 else
                 {
                     for (size_t g = 0; g < _group; ++g)
-                        CpuGemm(CblasNoTrans, CblasNoTrans, _siD, _siS, _siW, Type(1), weight + _grW * g, _ldW, src + _grS * g, _ldS, Type(0), dst + _grD * g, _ldD);
+                        CpuGemm(CblasNoTrans, CblasNoTrans, _siD, siS, _siW, Type(1), weight + _grW * g, _ldW, src + grS * g, ldS, beta, dst + _grD * g, _ldD);
                 }
+            }
+        }
+
+    private:
+        size_t Prepare()
+        {
+            const Tensors & weight = this->Weight();
+            _packed = Tensor();
+            _convolution.Release();
+            _depthwise = false;
+            if (_block > 1)
+            {
+                _algorithm = ConvolutionAlgorithmTypeDirect;
+                _depthwise = _group > 1;
+                ReorderWeight();
+                return 1;
+            }
+            if ((_algorithm == ConvolutionAlgorithmTypeAuto || _algorithm == ConvolutionAlgorithmTypeDirect) && !_residual)
+                _convolution.Init(_srcC, _srcH, _srcW, _trans, _dstC, _trans, _kernelY, _kernelX, _dilationY, _dilationX, _strideY, _strideX, _padY, _padX, _padH, _padW, _group, _activation);
+            if (_convolution.Enable())
+            {
+                _algorithm = ConvolutionAlgorithmTypeDirect;
+                _convolution.SetParams(weight[0].CpuData(), _trans, NULL, _biasTerm ? weight[1].CpuData() : NULL, 
+                    _activation == ActivationFunctionTypePrelu ? weight.back().CpuData() : _params);
+                return _convolution.BufferSize();
+            }
+            _depthwise = _group == _srcC && _group == _dstC && _group > 1 && 
+                (_algorithm == ConvolutionAlgorithmTypeAuto || _algorithm == ConvolutionAlgorithmTypeDirect);
+            if (_depthwise)
+            {
+                _algorithm = ConvolutionAlgorithmTypeDirect;
+                return 1;
+            }
+            if (_algorithm == ConvolutionAlgorithmTypeAuto || _algorithm == ConvolutionAlgorithmTypeWinograd)
+            {
+                _winograd.Init(Shape({ _srcC, _srcH, _srcW }), _dstC, Shape({ _kernelY, _kernelX }), Shape({ _strideY, _strideX }), 
+                    Shape({ _dilationY, _dilationX }), Shape({ _padY, _padX, _padH, _padW }), _group);
+                if (_winograd.Enable() && !_trans && (_algorithm == ConvolutionAlgorithmTypeWinograd || (_srcC >= 16 && _dstC >= 16)))
+                    _algorithm = ConvolutionAlgorithmTypeWinograd;
+                else
+                    _algorithm = ConvolutionAlgorithmTypeImgToCol;
+            }
+            switch (_algorithm)
+            {
+            case ConvolutionAlgorithmTypeWinograd:
+            {
+                Tensor filter, packed;
+                if (this->Restore(0, _winograd.FilterShape(), filter) && (_winograd.PackedShape().empty() || this->Restore(1, _winograd.PackedShape(), packed)))
+                    _winograd.SetFilter(filter, packed);
+                else if (this->Cached("winograd", _winograd.FilterShape(), filter) && (_winograd.PackedShape().empty() || this->Cached("winogradPacked", _winograd.PackedShape(), packed)))
+                    _winograd.SetFilter(filter, packed);
+                else
+                {
+                    _winograd.SetFilter(weight[0].CpuData());
+                    Tensors state;
+                    _winograd.Export(state);
+                    this->Store("winograd", state[0]);
+                    if (state.size() > 1)
+                        this->Store("winogradPacked", state[1]);
+                }
+                return _winograd.SrcBufSize() + _winograd.DstBufSize();
+            }
+            case ConvolutionAlgorithmTypeDirect:
+                return 1;
+            default:
+            {
+                _algorithm = ConvolutionAlgorithmTypeImgToCol;
+                PackWeight();
+                if (_is1x1)
+                    return 1;
+                _tileH = std::max<size_t>(SYNET_CONVOLUTION_TILE_SIZE / (_kernelY*_kernelX*_srcC*_dstW*sizeof(Type)), 1);
+                size_t tiles = (_dstH + _tileH - 1) / _tileH;
+                _tileH = (_dstH + tiles - 1) / tiles;
+                return _kernelY*_kernelX*_srcC*_tileH*_dstW;
+            }
+            }
+        }
+
+        ConvolutionAlgorithmType Tune()
+        {
+            std::stringstream key;
+            key << "i=" << _srcC << "x" << _srcH << "x" << _srcW << " o=" << _dstC << " k=" << _kernelY << "x" << _kernelX 
+                << " s=" << _strideY << "x" << _strideX << " d=" << _dilationY << "x" << _dilationX 
+                << " p=" << _padY << "x" << _padX << "x" << _padH << "x" << _padW << " g=" << _group 
+                << " f=" << (_trans ? "nhwc" : "nchw") << " t=" << GetThreadNumber();
+            ConvolutionTuner & tuner = GlobalConvolutionTuner();
+            ConvolutionAlgorithmType best = ConvolutionAlgorithmTypeImgToCol;
+            if (tuner.Find(key.str(), best))
+                return best;
+
+            const ConvolutionAlgorithmType algorithms[] = { ConvolutionAlgorithmTypeImgToCol, ConvolutionAlgorithmTypeWinograd, ConvolutionAlgorithmTypeDirect };
+            std::vector<Type> src(_srcSize, Type(1)), dst(_dstSize);
+            double bestTime = DBL_MAX;
+            for (size_t a = 0; a < 3; ++a)
+            {
+                _algorithm = algorithms[a];
+                std::vector<Type> buf(Prepare());
+                if (_algorithm != algorithms[a])
+                    continue;
+                double time = DBL_MAX;
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    double start = ConvolutionTuner::Time();
+                    ForwardCpu(src.data(), buf.data(), NULL, dst.data());
+                    time = std::min(time, ConvolutionTuner::Time() - start);
+                    if (time > 2.0 * bestTime)
+                        break;
+                }
+                if (time < bestTime)
+                {
+                    best = _algorithm;
+                    bestTime = time;
+                }
+            }
+            tuner.Update(key.str(), best);
+            return best;
+        }
+
+        void ReorderWeight()
+        {
+            const Tensors & weight = this->Weight();
+            const Type * pw = weight[0].CpuData();
+            size_t B = _block, dstCB = (_dstC + B - 1) / B, kernel = _kernelY * _kernelX;
+            Shape shape({ _depthwise ? _srcC * kernel : dstCB * kernel * _srcC * B });
+            if (!this->Restore(0, shape, _blockedWeight) && !this->Cached("blockedWeight", shape, _blockedWeight))
+            {
+                _blockedWeight.Reshape(shape, Type(0));
+                Type * pr = _blockedWeight.CpuData();
+                for (size_t d = 0; d < _dstC; ++d)
+                {
+                    for (size_t k = 0; k < kernel; ++k)
+                    {
+                        if (_depthwise)
+                            pr[((d / B) * kernel + k) * B + d % B] = pw[d * kernel + k];
+                        else
+                            for (size_t c = 0; c < _srcC; ++c)
+                                pr[(((d / B) * kernel + k) * _srcC + c) * B + d % B] = pw[(d * _srcC + c) * kernel + k];
+                    }
+                }
+                this->Store("blockedWeight", _blockedWeight);
+            }
+            if (!this->Restore(1, Shape({ dstCB * B }), _blockedBias) && !this->Cached("blockedBias", Shape({ dstCB * B }), _blockedBias))
+            {
+                _blockedBias.Reshape(Shape({ dstCB * B }), Type(0));
                 if (_biasTerm)
-                    CpuAddBias(this->Weight()[1].CpuData(), _dstC, _dstH*_dstW, dst, _trans);
-                switch (_activation)
+                    memcpy(_blockedBias.CpuData(), weight[1].CpuData(), _dstC * sizeof(Type));
+                this->Store("blockedBias", _blockedBias);
+            }
+            _blockedSlope = Tensor();
+            if (_activation == ActivationFunctionTypePrelu && !this->Restore(2, Shape({ dstCB * B }), _blockedSlope) && 
+                !this->Cached("blockedSlope", Shape({ dstCB * B }), _blockedSlope))
+            {
+                _blockedSlope.Reshape(Shape({ dstCB * B }), Type(0));
+                memcpy(_blockedSlope.CpuData(), weight.back().CpuData(), _dstC * sizeof(Type));
+                this->Store("blockedSlope", _blockedSlope);
+            }
+        }
+
+        void PackWeight()
+        {
+            _packed = Tensor();
+#ifdef SYNET_GEMM_PACKED
+            const Type * weight = this->Weight()[0].CpuData();
+            if (_trans)
+            {
+                Shape shape({ CpuGemmPackSizeB<Type>(_siW, _siD) });
+                if (_group == 1 && CpuGemmPackable(_siS, _siD, _siW) && !this->Restore(0, shape, _packed) && !this->Cached("packed", shape, _packed))
+                {
+                    _packed.Reshape(shape);
+                    CpuGemmPackB(CblasNoTrans, _siW, _siD, weight, _ldW, _packed.CpuData());
+                    this->Store("packed", _packed);
+                }
+            }
+            else
+            {
+                size_t size = CpuGemmPackSizeA<Type>(_siD, _siW);
+                if (CpuGemmPackable(_siD, _siS, _siW) && !this->Restore(0, Shape({ size * _group }), _packed) && !this->Cached("packed", Shape({ size * _group }), _packed))
                 {
-                case ActivationFunctionTypeIdentity:
-                    break;
-                case ActivationFunctionTypeRelu:
-                    CpuRelu(dst, _dstSize, 0.0f, dst);
-                    break;
-                case ActivationFunctionTypeLeakyRelu:
-                    CpuRelu(dst, _dstSize, _params[0], dst);
-                    break;
-                case ActivationFunctionTypeRestrictRange:
-                    CpuRestrictRange(dst, _dstSize, _params[0], _params[1], dst);
-                    break;
-                case ActivationFunctionTypePrelu:
-                    Detail::PreluLayerForwardCpu(dst, this->Weight().back().CpuData(), _dstC, _dstH*_dstW, dst, _trans);
-                    break;
-                default:
-                    assert(0);
+                    _packed.Reshape({ size * _group });
+                    for (size_t g = 0; g < _group; ++g)
+                        CpuGemmPackA(CblasNoTrans, _siD, _siW, weight + _grW * g, _ldW, _packed.CpuData() + size * g);
+                    this->Store("packed", _packed);
                 }
             }
+#endif
         }
 
-    private:
-        bool _is1x1, _biasTerm;
+        bool _is1x1, _biasTerm, _depthwise, _residual;
         int _trans;
         size_t _kernelY, _kernelX, _strideY, _strideX, _dilationY, _dilationX, _padY, _padX, _padH, _padW;
-        size_t _axis, _group, _num, _srcC, _srcH, _srcW, _dstC, _dstH, _dstW, _srcSize, _dstSize;
-        size_t _ldW, _ldS, _ldD, _grW, _grS, _grD, _siW, _siS, _siD;
+        size_t _axis, _group, _num, _srcC, _srcH, _srcW, _dstC, _dstH, _dstW, _srcSize, _dstSize, _tileH;
+        size_t _ldW, _ldS, _ldD, _grW, _grS, _grD, _siW, _siS, _siD, _srcBlock, _dstBlock, _block;
         ActivationFunctionType _activation;
+        ConvolutionAlgorithmType _algorithm;
         float _params[2];
 
         Convolution<Type> _convolution;
+        Winograd<Type> _winograd;
+        Tensor _packed, _blockedWeight, _blockedBias, _blockedSlope;
     };
 }
\ No newline at end of file
@@ -115,6 +115,11 @@ namespace Synet
             }
         }
 
+        virtual size_t MemoryUsage() const
+        {
+            return (_bboxPreds.Size() + _bboxPermute.Size() + _confPermute.Size()) * sizeof(Type);
+        }
+
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
@@ -172,17 +177,24 @@ namespace Synet
                 IndexMap indices;
                 size_t numDet = 0;
                 for (size_t c = 0; c < _numClasses; ++c)
+                    if (c != _backgroundLabelId)
+                        indices[(int)c];
+                ParallelFor(0, _numClasses, 1, [&](size_t begin, size_t end)
                 {
-                    if (c == _backgroundLabelId)
-                        continue;
-                    assert(confScores.find((int)c) != confScores.end());
-                    const Floats & scores = confScores.find((int)c)->second;
-                    int label = _shareLocation ? -1 : (int)c;
-                    assert(decodeBboxes.find(label) != decodeBboxes.end());
-                    const NormalizedBBoxes & bboxes = decodeBboxes.find(label)->second;
-                    ApplyNMSFast(bboxes, scores, _confidenceThreshold, _nmsThreshold, _eta, _topK, indices[(int)c]);
-                    numDet += indices[(int)c].size();
-                }
+                    for (size_t c = begin; c < end; ++c)
+                    {
+                        if (c == _backgroundLabelId)
+                            continue;
+                        assert(confScores.find((int)c) != confScores.end());
+                        const Floats & scores = confScores.find((int)c)->second;
+                        int label = _shareLocation ? -1 : (int)c;
+                        assert(decodeBboxes.find(label) != decodeBboxes.end());
+                        const NormalizedBBoxes & bboxes = decodeBboxes.find(label)->second;
+                        ApplyNMSFast(bboxes, scores, _confidenceThreshold, _nmsThreshold, _eta, _topK, indices.find((int)c)->second);
+                    }
+                });
+                for (IndexMap::const_iterator it = indices.begin(); it != indices.end(); ++it)
+                    numDet += it->second.size();
                 if (_keepTopK > -1 && numDet > (size_t)_keepTopK)
                 {
                     ScoreIndexPairs scoreIndexPairs;
@@ -97,10 +97,7 @@ namespace Synet
             
             _src.resize(src.size());
             for (size_t i = 0; i < src.size(); ++i)
-            {
-                assert(src[i]->Shape() == src[0]->Shape());
-                _src[i] = src[i]->CpuData();
-            }
+                assert(src[i]->Shape() == src[0]->Shape() && src[i]->Format() == src[0]->Format());
             dst[0]->Reshape(src[0]->Shape(), Type(), src[0]->Format());
         }
 
@@ -109,6 +106,9 @@ namespace Synet
         {
             SYNET_PERF_FUNC();
 
+            for (size_t i = 0; i < src.size(); ++i)
+                _src[i] = src[i]->CpuData();
+
             Detail::EltwiseLayerForwardCpu(_src.data(), _coefficients.data(), _src.size(), dst[0]->Size(), _operation, dst[0]->CpuData());
         }
 
@@ -33,6 +33,20 @@ namespace Synet
     {
         template <class T> void FusedLayerForwardCpu0(const T * src, const T * bias, const T * scale, size_t count, size_t size, T * dst, int trans)
         {
+            if (trans)
+            {
+                for (size_t j = 0; j < size; ++j)
+                {
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        T x = src[i] + bias[i];
+                        dst[i] = (x - ::abs(x))*scale[i] + std::max(T(0), x);
+                    }
+                    src += count;
+                    dst += count;
+                }
+                return;
+            }
             for (size_t i = 0; i < count; ++i)
             {
                 const T b = bias[i];
@@ -49,6 +63,20 @@ namespace Synet
 
         template <class T> void FusedLayerForwardCpu1(const T * src, const T * bias0, const T * scale1, const T * bias1, size_t count, size_t size, T * dst, int trans)
         {
+            if (trans)
+            {
+                for (size_t j = 0; j < size; ++j)
+                {
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        T x = src[i] + bias0[i];
+                        dst[i] = std::max(T(0), -x)*scale1[i] + bias1[i] + std::max(T(0), x);
+                    }
+                    src += count;
+                    dst += count;
+                }
+                return;
+            }
             for (size_t i = 0; i < count; ++i)
             {
                 const T b0 = bias0[i];
@@ -66,6 +94,20 @@ namespace Synet
 
         template <class T> void FusedLayerForwardCpu2(const T * src, const T * scale, const T * bias, size_t count, size_t size, T slope, T * dst, int trans)
         {
+            if (trans)
+            {
+                for (size_t j = 0; j < size; ++j)
+                {
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        T x = src[i]*scale[i] + bias[i];
+                        dst[i] = std::max(x, T(0)) + slope * std::min(x, T(0));
+                    }
+                    src += count;
+                    dst += count;
+                }
+                return;
+            }
             for (size_t i = 0; i < count; ++i)
             {
                 const T s = scale[i];
@@ -82,6 +124,20 @@ namespace Synet
 
         template <class T> void FusedLayerForwardCpu3(const T * src, const T * bias, const T * scale, size_t count, size_t size, T * dst, int trans)
         {
+            if (trans)
+            {
+                for (size_t j = 0; j < size; ++j)
+                {
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        T x = src[i] + bias[i];
+                        dst[i] = std::max(T(0), x) + std::min(T(0), x)*scale[i];
+                    }
+                    src += count;
+                    dst += count;
+                }
+                return;
+            }
             for (size_t i = 0; i < count; ++i)
             {
                 const T b = bias[i];
@@ -143,6 +199,8 @@ namespace Synet
                 assert(weight.size() == 3);
                 _t0.bias.Share(weight[0]);
                 _t0.count = _t0.bias.Size();
+                if (this->Restore(0, _t0.bias.Shape(), _t0.scale))
+                    break;
                 _t0.scale.Reshape(_t0.bias.Shape());
                 assert(weight[1].Size() == _t0.count || weight[1].Size() == 1);
                 if (weight[1].Size() == _t0.count)
@@ -183,9 +241,14 @@ namespace Synet
                 assert(weight.size() == 4 && weight[0].Count() == 1);
                 assert(weight[0].Shape() == weight[1].Shape() && weight[0].Shape() == weight[2].Shape() && weight[0].Shape() == weight[3].Shape());
                 assert(fused.floats().size() == 2);
+                _t2.count = weight[0].Size();
+                _t2.slope = fused.floats()[1];
+                if (this->Restore(0, weight[0].Shape(), _t2.scale) && this->Restore(1, weight[0].Shape(), _t2.bias))
+                    break;
+                _t2.scale = Tensor();
+                _t2.bias = Tensor();
                 _t2.scale.Reshape(weight[0].Shape());
                 _t2.bias.Reshape(weight[0].Shape());
-                _t2.count = _t2.scale.Size();
                 for (size_t i = 0; i < _t2.count; ++i)
                 {
                     Type eps = fused.floats()[0];
@@ -194,7 +257,6 @@ namespace Synet
                     _t2.scale.CpuData()[i] = scale*weight[2].CpuData()[i];
                     _t2.bias.CpuData()[i] = bias*weight[2].CpuData()[i] + weight[3].CpuData()[i];
                 }
-                _t2.slope = fused.floats()[1];
                 break;
             case 3:
             {
@@ -209,6 +271,14 @@ namespace Synet
             }
 
             _trans = src[0]->Format() == TensorFormatNhwc;
+            _block = TensorFormatBlock(src[0]->Format());
+            if (_block > 1)
+            {
+                assert(src[0]->Count() == 5);
+                _channels = src[0]->Axis(1) * _block;
+                _spatial = src[0]->Axis(2) * src[0]->Axis(3);
+                _blocks = src[0]->Size() / _block / _spatial;
+            }
             switch (_type)
             {
             case 0:
@@ -244,6 +314,22 @@ namespace Synet
             }
         }
 
+        virtual void Compile(LayerParam & /*param*/, typename Base::Tensors & state) const
+        {
+            if (_type == 0)
+                state.push_back(_t0.scale);
+            else if (_type == 2)
+            {
+                state.push_back(_t2.scale);
+                state.push_back(_t2.bias);
+            }
+        }
+
+        virtual size_t MemoryUsage() const
+        {
+            return (_t0.scale.Size() + _t2.scale.Size() + _t2.bias.Size()) * sizeof(Type);
+        }
+
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
@@ -262,19 +348,42 @@ namespace Synet
 #else
             SYNET_PERF_FUNC();
 #endif
+            if (_block > 1)
+            {
+                for (size_t i = 0; i < _blocks; ++i)
+                {
+                    size_t offset = i * _block % _channels;
+                    ForwardCpu(src + i * _block * _spatial, offset, _block, _spatial, dst + i * _block * _spatial, 1);
+                }
+            }
+            else
+            {
+                switch (_type)
+                {
+                case 0: ForwardCpu(src, 0, _t0.count, _t0.size, dst, _trans); break;
+                case 1: ForwardCpu(src, 0, _t1.count, _t1.size, dst, _trans); break;
+                case 2: ForwardCpu(src, 0, _t2.count, _t2.size, dst, _trans); break;
+                case 3: ForwardCpu(src, 0, _t3.count, _t3.size, dst, _trans); break;
+                default: assert(0);
+                }
+            }
+        }
+
+        void ForwardCpu(const Type * src, size_t offset, size_t count, size_t size, Type * dst, int trans)
+        {
             switch (_type)
             {
             case 0:
-                Detail::FusedLayerForwardCpu0(src, _t0.bias.CpuData(), _t0.scale.CpuData(), _t0.count, _t0.size, dst, _trans);
+                Detail::FusedLayerForwardCpu0(src, _t0.bias.CpuData() + offset, _t0.scale.CpuData() + offset, count, size, dst, trans);
                 break;
             case 1:
-                Detail::FusedLayerForwardCpu1(src, _t1.bias0.CpuData(), _t1.scale1.CpuData(), _t1.bias1.CpuData(), _t1.count, _t1.size, dst, _trans);
+                Detail::FusedLayerForwardCpu1(src, _t1.bias0.CpuData() + offset, _t1.scale1.CpuData() + offset, _t1.bias1.CpuData() + offset, count, size, dst, trans);
                 break;
             case 2:
-                Detail::FusedLayerForwardCpu2(src, _t2.scale.CpuData(), _t2.bias.CpuData(), _t2.count, _t2.size, _t2.slope, dst, _trans);
+                Detail::FusedLayerForwardCpu2(src, _t2.scale.CpuData() + offset, _t2.bias.CpuData() + offset, count, size, _t2.slope, dst, trans);
                 break;
             case 3:
-                Detail::FusedLayerForwardCpu3(src, _t3.bias.CpuData(), _t3.scale.CpuData(), _t3.count, _t3.size, dst, _trans);
+                Detail::FusedLayerForwardCpu3(src, _t3.bias.CpuData() + offset, _t3.scale.CpuData() + offset, count, size, dst, trans);
                 break;
             default:
                 assert(0);
@@ -286,6 +395,7 @@ namespace Synet
         typedef typename Base::Tensors Tensors;
 
         int _type, _trans;
+        size_t _block, _channels, _spatial, _blocks;
 
         struct T0
         {
@@ -27,6 +27,7 @@
 #include "Synet/Common.h"
 #include "Synet/Layer.h"
 #include "Synet/Utils/Math.h"
+#include "Synet/Utils/Gemm.h"
 
 namespace Synet
 {
@@ -60,6 +61,7 @@ namespace Synet
         typedef T Type;
         typedef Layer<T> Base;
         typedef typename Base::TensorPtrs TensorPtrs;
+        typedef typename Base::Tensors Tensors;
 
         InnerProductLayer(const LayerParam & param)
             : Base(param)
@@ -100,6 +102,24 @@ namespace Synet
             dstShape.resize(_axis + 1);
             dstShape[_axis] = _Ndim;
             dst[0]->Reshape(dstShape, Type(), src[0]->Format());
+
+            _packed = Tensor();
+#ifdef SYNET_GEMM_PACKED
+            Shape packed({ CpuGemmPackSizeB<Type>(_Kdim, _Ndim) });
+            if (src.size() == 1 && !(_Mdim == 1 && !_transposeB) && CpuGemmPackable(_Mdim, _Ndim, _Kdim) && 
+                !this->Restore(0, packed, _packed) && !this->Cached("packed", packed, _packed))
+            {
+                _packed.Reshape(packed);
+                CpuGemmPackB(_transposeB ? CblasNoTrans : CblasTrans, _Kdim, _Ndim, this->Weight()[0].CpuData(), _Ndim, _packed.CpuData());
+                this->Store("packed", _packed);
+            }
+#endif
+        }
+
+        virtual void Compile(LayerParam & /*param*/, Tensors & state) const
+        {
+            if (_packed.Size())
+                state.push_back(_packed);
         }
 
     protected:
@@ -124,7 +144,10 @@ namespace Synet
             }
             else
             {
-                CpuGemm<Type>(_transposeA ? CblasNoTrans : CblasTrans, _transposeB ? CblasNoTrans : CblasTrans, _Mdim, _Ndim, _Kdim, Type(1), a, _Kdim, b, _Ndim, Type(0), c, _Ndim);
+                if (_packed.Size() && b == this->Weight()[0].CpuData())
+                    CpuGemmPackedB<Type>(_transposeA ? CblasNoTrans : CblasTrans, _Mdim, _Ndim, _Kdim, Type(1), a, _Kdim, _packed.CpuData(), Type(0), c, _Ndim);
+                else
+                    CpuGemm<Type>(_transposeA ? CblasNoTrans : CblasTrans, _transposeB ? CblasNoTrans : CblasTrans, _Mdim, _Ndim, _Kdim, Type(1), a, _Kdim, b, _Ndim, Type(0), c, _Ndim);
                 if (_biasTerm)
                     CpuAddBias(this->Weight()[1].CpuData(), _Ndim, _Mdim, c);
             }
@@ -136,5 +159,6 @@ namespace Synet
 
         size_t _Mdim, _Kdim, _Ndim, _axis;
         bool _biasTerm, _transposeA, _transposeB;
+        Tensor _packed;
     };
 }
@@ -108,6 +108,11 @@ namespace Synet
             }
         }
 
+        virtual size_t MemoryUsage() const
+        {
+            return _buffer.Size() * sizeof(Type);
+        }
+
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
@@ -64,6 +64,11 @@ namespace Synet
             }
         }
 
+        virtual size_t MemoryUsage() const
+        {
+            return (_buffer.Size() + _norm.Size() + _sumSpatialMultiplier.Size() + _bufferSpatial.Size() + _sumChannelMultiplier.Size()) * sizeof(Type);
+        }
+
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
@@ -99,21 +99,25 @@ namespace Synet
                 switch (_count)
                 {
                 case 2:
-                    for (size_t i = 0; i < _srcShape[0]; ++i)
+                    ParallelFor(0, _srcShape[0], 1, [=](size_t begin, size_t end)
                     {
-                        for (size_t j = 0; j < _srcShape[1]; ++j)
+                        for (size_t i = begin; i < end; ++i)
                         {
-                            size_t srcOffset = i*_srcStride[0] + j*_srcStride[1];
-                            size_t dstOffset = i*_dstStride[0] + j*_dstStride[1];
-                            pDst[dstOffset] = pSrc[srcOffset];
+                            for (size_t j = 0; j < _srcShape[1]; ++j)
+                            {
+                                size_t srcOffset = i*_srcStride[0] + j*_srcStride[1];
+                                size_t dstOffset = i*_dstStride[0] + j*_dstStride[1];
+                                pDst[dstOffset] = pSrc[srcOffset];
+                            }
                         }
-                    }
+                    });
                     break;
                 case 3:
-                    for (size_t i = 0; i < _srcShape[0]; ++i)
+                    ParallelFor(0, _srcShape[0]*_srcShape[1], 1, [=](size_t begin, size_t end)
                     {
-                        for (size_t j = 0; j < _srcShape[1]; ++j)
+                        for (size_t ij = begin; ij < end; ++ij)
                         {
+                            size_t i = ij / _srcShape[1], j = ij % _srcShape[1];
                             for (size_t k = 0; k < _srcShape[2]; ++k)
                             {
                                 size_t srcOffset = i*_srcStride[0] + j*_srcStride[1] + k*_srcStride[2];
@@ -121,13 +125,14 @@ namespace Synet
                                 pDst[dstOffset] = pSrc[srcOffset];
                             }
                         }
-                    }
+                    });
                     break;
                 case 4:
-                    for (size_t i = 0; i < _srcShape[0]; ++i)
+                    ParallelFor(0, _srcShape[0]*_srcShape[1], 1, [=](size_t begin, size_t end)
                     {
-                        for (size_t j = 0; j < _srcShape[1]; ++j)
+                        for (size_t ij = begin; ij < end; ++ij)
                         {
+                            size_t i = ij / _srcShape[1], j = ij % _srcShape[1];
                             for (size_t k = 0; k < _srcShape[2]; ++k)
                             {
                                 for (size_t l = 0; l < _srcShape[3]; ++l)
@@ -138,7 +143,7 @@ namespace Synet
                                 }
                             }
                         }
-                    }
+                    });
                     break;
                 default:
                     assert(0);
@@ -0,0 +1,410 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Common.h"
+#include "Synet/Layer.h"
+#include "Synet/Utils/Math.h"
+
+namespace Synet
+{
+    namespace Detail
+    {
+        template <class T, class F> SYNET_INLINE void PointwiseChannels(T * x, size_t size, const T * weight, size_t channel, size_t period, F func)
+        {
+            if (period == 0)
+            {
+                T w = weight[channel];
+                for (size_t i = 0; i < size; ++i)
+                    x[i] = func(x[i], w);
+            }
+            else
+            {
+                for (size_t j = 0; j < size; j += period)
+                    for (size_t c = 0; c < period; ++c)
+                        x[j + c] = func(x[j + c], weight[channel + c]);
+            }
+        }
+
+        template <class T> void PointwiseApply(PointwiseOperationType type, const T * weight, const T * src, T value, size_t channel, size_t period, T * x, size_t size)
+        {
+            switch (type)
+            {
+            case PointwiseOperationTypeAbs:
+                for (size_t i = 0; i < size; ++i)
+                    x[i] = ::abs(x[i]);
+                break;
+            case PointwiseOperationTypeAdd:
+                for (size_t i = 0; i < size; ++i)
+                    x[i] += value * src[i];
+                break;
+            case PointwiseOperationTypeBias:
+                if (weight)
+                    PointwiseChannels(x, size, weight, channel, period, [](T a, T b) { return a + b; });
+                else
+                    for (size_t i = 0; i < size; ++i)
+                        x[i] += value;
+                break;
+            case PointwiseOperationTypeDiv:
+                for (size_t i = 0; i < size; ++i)
+                    x[i] /= src[i];
+                break;
+            case PointwiseOperationTypeExp:
+                for (size_t i = 0; i < size; ++i)
+                    x[i] = ::exp(x[i]);
+                break;
+            case PointwiseOperationTypeLog:
+                for (size_t i = 0; i < size; ++i)
+                    x[i] = ::log(x[i]);
+                break;
+            case PointwiseOperationTypeMax:
+                if (src)
+                    for (size_t i = 0; i < size; ++i)
+                        x[i] = std::max(x[i], src[i]);
+                else
+                    for (size_t i = 0; i < size; ++i)
+                        x[i] = std::max(x[i], value);
+                break;
+            case PointwiseOperationTypeMin:
+                if (src)
+                    for (size_t i = 0; i < size; ++i)
+                        x[i] = std::min(x[i], src[i]);
+                else
+                    for (size_t i = 0; i < size; ++i)
+                        x[i] = std::min(x[i], value);
+                break;
+            case PointwiseOperationTypeMul:
+                for (size_t i = 0; i < size; ++i)
+                    x[i] *= src[i];
+                break;
+            case PointwiseOperationTypeNeg:
+                for (size_t i = 0; i < size; ++i)
+                    x[i] = -x[i];
+                break;
+            case PointwiseOperationTypePrelu:
+                PointwiseChannels(x, size, weight, channel, period, [](T a, T b) { return CpuRelu(a, b); });
+                break;
+            case PointwiseOperationTypeRelu:
+                for (size_t i = 0; i < size; ++i)
+                    x[i] = CpuRelu(x[i], value);
+                break;
+            case PointwiseOperationTypeRsqrt:
+                for (size_t i = 0; i < size; ++i)
+                    x[i] = T(1) / ::sqrt(x[i]);
+                break;
+            case PointwiseOperationTypeScale:
+                if (weight)
+                    PointwiseChannels(x, size, weight, channel, period, [](T a, T b) { return a * b; });
+                else
+                    for (size_t i = 0; i < size; ++i)
+                        x[i] *= value;
+                break;
+            case PointwiseOperationTypeSigmoid:
+                CpuSigmoid(x, size, x);
+                break;
+            case PointwiseOperationTypeSqrt:
+                for (size_t i = 0; i < size; ++i)
+                    x[i] = ::sqrt(x[i]);
+                break;
+            case PointwiseOperationTypeTanh:
+                for (size_t i = 0; i < size; ++i)
+                    x[i] = ::tanh(x[i]);
+                break;
+            default:
+                assert(0);
+            }
+        }
+
+        template <class T, bool scale, bool bias, bool relu> void PointwiseAffine(const T * src, size_t size, const T * s, const T * b, T slope, size_t period, T * dst)
+        {
+            if (period == 0)
+            {
+                T _s = scale ? s[0] : T(1), _b = bias ? b[0] : T(0);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    T x = src[i];
+                    if (scale)
+                        x *= _s;
+                    if (bias)
+                        x += _b;
+                    dst[i] = relu ? CpuRelu(x, slope) : x;
+                }
+            }
+            else
+            {
+                for (size_t j = 0; j < size; j += period)
+                {
+                    for (size_t c = 0; c < period; ++c)
+                    {
+                        T x = src[j + c];
+                        if (scale)
+                            x *= s[c];
+                        if (bias)
+                            x += b[c];
+                        dst[j + c] = relu ? CpuRelu(x, slope) : x;
+                    }
+                }
+            }
+        }
+
+        template <class T> void PointwiseGate(const T * src, size_t size, T * dst)
+        {
+            for (size_t i = 0; i < size; ++i)
+                dst[i] = src[i] * CpuSigmoid(src[i]);
+        }
+    }
+
+    template <class T> class PointwiseLayer : public Synet::Layer<T>
+    {
+    public:
+        typedef T Type;
+        typedef Layer<T> Base;
+        typedef typename Base::Tensor Tensor;
+        typedef typename Base::Tensors Tensors;
+        typedef typename Base::TensorPtrs TensorPtrs;
+
+        PointwiseLayer(const LayerParam & param)
+            : Base(param)
+        {
+        }
+
+        virtual void Reshape(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
+        {
+            const std::vector<PointwiseOperationParam> & operations = this->Param().pointwise().operations();
+            const Tensors & weight = this->Weight();
+            _operations.resize(operations.size());
+            _channels = 0;
+            for (size_t i = 0; i < operations.size(); ++i)
+            {
+                Operation & operation = _operations[i];
+                operation.type = operations[i].type();
+                operation.weight = NULL;
+                operation.scalar = true;
+                if (operations[i].weight() >= 0)
+                {
+                    const Tensor & w = weight[operations[i].weight()];
+                    operation.weight = w.CpuData();
+                    operation.scalar = w.Size() == 1;
+                    if (!operation.scalar)
+                    {
+                        assert(_channels == 0 || _channels == w.Size());
+                        _channels = w.Size();
+                    }
+                }
+                assert(operation.weight || operation.type != PointwiseOperationTypePrelu);
+                operation.src = operations[i].src();
+                assert(operation.src < (int)src.size());
+                assert(operation.src >= 0 || (operation.type != PointwiseOperationTypeAdd && operation.type != PointwiseOperationTypeMul && operation.type != PointwiseOperationTypeDiv));
+                operation.value = operations[i].value();
+            }
+
+            for (size_t i = 1; i < src.size(); ++i)
+                assert(src[i]->Shape() == src[0]->Shape() && src[i]->Format() == src[0]->Format());
+            _trans = src[0]->Format() == TensorFormatNhwc;
+            _block = TensorFormatBlock(src[0]->Format());
+            _spatial = 1;
+            if (_channels)
+            {
+                if (_block > 1)
+                {
+                    assert(src[0]->Count() == 5 && src[0]->Axis(1) * _block == _channels);
+                    _spatial = src[0]->Axis(2) * src[0]->Axis(3);
+                }
+                else if (_trans)
+                    assert(src[0]->Axis(-1) == _channels);
+                else
+                {
+                    assert(src[0]->Count() >= 2 && src[0]->Axis(1) == _channels);
+                    _spatial = src[0]->Size(2);
+                }
+            }
+            _kernel = Kernel();
+            _src.resize(src.size());
+            dst[0]->Reshape(src[0]->Shape(), Type(), src[0]->Format());
+        }
+
+        virtual bool RowWindow(size_t & kernel, size_t & stride, size_t & pad) const
+        {
+            kernel = 1;
+            stride = 1;
+            pad = 0;
+            return _channels == 0 || _trans;
+        }
+
+        virtual void ForwardRows(const TensorPtrs & src, const TensorPtrs & /*buf*/, const TensorPtrs & dst, size_t dstY0, size_t dstY1)
+        {
+            for (size_t i = 0; i < src.size(); ++i)
+                _src[i] = src[i]->CpuData();
+            size_t row = dst[0]->Size(2);
+            ForwardRange(dstY0 * row, dstY1 * row, dst[0]->CpuData());
+        }
+
+    protected:
+        virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
+        {
+            SYNET_PERF_FUNC();
+            for (size_t i = 0; i < src.size(); ++i)
+                _src[i] = src[i]->CpuData();
+            Type * pDst = dst[0]->CpuData();
+            size_t size = dst[0]->Size();
+            if (_channels == 0 || _trans)
+                ForwardRange(0, size, pDst);
+            else if (_block > 1)
+            {
+                size_t group = _spatial * _block, step = TILE / _block * _block;
+                for (size_t g = 0, n = size / group; g < n; ++g)
+                {
+                    size_t channel = g * _block % _channels;
+                    for (size_t i = 0; i < group; i += step)
+                        ForwardTile(g * group + i, std::min(step, group - i), channel, _block, pDst);
+                }
+            }
+            else
+            {
+                for (size_t r = 0, n = size / _spatial; r < n; ++r)
+                    for (size_t i = 0; i < _spatial; i += TILE)
+                        ForwardTile(r * _spatial + i, std::min<size_t>(TILE, _spatial - i), r % _channels, 0, pDst);
+            }
+        }
+
+    private:
+        void ForwardRange(size_t begin, size_t end, Type * dst)
+        {
+            if (_channels == 0)
+            {
+                for (size_t i = begin; i < end; i += TILE)
+                    ForwardTile(i, std::min<size_t>(TILE, end - i), 0, 0, dst);
+            }
+            else if (_channels <= TILE)
+            {
+                size_t step = TILE / _channels * _channels;
+                for (size_t i = begin; i < end; i += step)
+                    ForwardTile(i, std::min(step, end - i), 0, _channels, dst);
+            }
+            else
+            {
+                for (size_t i = begin; i < end; i += _channels)
+                    for (size_t c = 0; c < _channels; c += TILE)
+                        ForwardTile(i + c, std::min<size_t>(TILE, _channels - c), c, std::min<size_t>(TILE, _channels - c), dst);
+            }
+        }
+
+        enum KernelType
+        {
+            KernelGeneric,
+            KernelScale,
+            KernelBias,
+            KernelScaleBias,
+            KernelRelu,
+            KernelScaleRelu,
+            KernelBiasRelu,
+            KernelScaleBiasRelu,
+            KernelGate,
+        };
+
+        struct Operation
+        {
+            PointwiseOperationType type;
+            const Type * weight;
+            bool scalar;
+            int src;
+            Type value;
+        };
+        typedef std::vector<Operation> Operations;
+
+        enum { TILE = SYNET_POINTWISE_TILE_SIZE };
+
+        KernelType Kernel()
+        {
+            const Operations & ops = _operations;
+            if (ops.size() == 2 && ops[0].type == PointwiseOperationTypeSigmoid && ops[1].type == PointwiseOperationTypeMul && ops[1].src == 0)
+                return KernelGate;
+            size_t i = 0;
+            _scale = NULL, _bias = NULL;
+            if (i < ops.size() && ops[i].type == PointwiseOperationTypeScale && ops[i].weight && !ops[i].scalar)
+                _scale = ops[i++].weight;
+            if (i < ops.size() && ops[i].type == PointwiseOperationTypeBias && ops[i].weight && !ops[i].scalar)
+                _bias = ops[i++].weight;
+            bool relu = i < ops.size() && ops[i].type == PointwiseOperationTypeRelu;
+            if (relu)
+                _slope = ops[i++].value;
+            if (i != ops.size() || ops.empty())
+                return KernelGeneric;
+            return KernelType(KernelScale - 1 + (_scale ? 1 : 0) + (_bias ? 2 : 0) + (relu ? 4 : 0));
+        }
+
+        void ForwardTile(size_t offset, size_t size, size_t channel, size_t period, Type * dst)
+        {
+            const Type * src = _src[0] + offset;
+            dst += offset;
+            switch (_kernel)
+            {
+            case KernelScale:
+                Detail::PointwiseAffine<Type, true, false, false>(src, size, _scale + channel, _bias, _slope, period, dst);
+                break;
+            case KernelBias:
+                Detail::PointwiseAffine<Type, false, true, false>(src, size, _scale, _bias + channel, _slope, period, dst);
+                break;
+            case KernelScaleBias:
+                Detail::PointwiseAffine<Type, true, true, false>(src, size, _scale + channel, _bias + channel, _slope, period, dst);
+                break;
+            case KernelRelu:
+                Detail::PointwiseAffine<Type, false, false, true>(src, size, _scale, _bias, _slope, 0, dst);
+                break;
+            case KernelScaleRelu:
+                Detail::PointwiseAffine<Type, true, false, true>(src, size, _scale + channel, _bias, _slope, period, dst);
+                break;
+            case KernelBiasRelu:
+                Detail::PointwiseAffine<Type, false, true, true>(src, size, _scale, _bias + channel, _slope, period, dst);
+                break;
+            case KernelScaleBiasRelu:
+                Detail::PointwiseAffine<Type, true, true, true>(src, size, _scale + channel, _bias + channel, _slope, period, dst);
+                break;
+            case KernelGate:
+                Detail::PointwiseGate(src, size, dst);
+                break;
+            default:
+            {
+                Type tile[TILE];
+                memcpy(tile, src, size * sizeof(Type));
+                for (size_t i = 0; i < _operations.size(); ++i)
+                {
+                    const Operation & op = _operations[i];
+                    Detail::PointwiseApply(op.type, op.weight, op.src >= 0 ? _src[op.src] + offset : NULL, op.value, op.scalar ? 0 : channel, op.scalar ? 0 : period, tile, size);
+                }
+                memcpy(dst, tile, size * sizeof(Type));
+            }
+            }
+        }
+
+        Operations _operations;
+        KernelType _kernel;
+        const Type * _scale, * _bias;
+        Type _slope;
+        size_t _channels, _spatial, _block;
+        int _trans;
+        std::vector<const Type*> _src;
+    };
+}
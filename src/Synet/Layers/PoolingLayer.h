@@ -33,68 +33,76 @@ namespace Synet
     namespace Detail
     {
         template <class T> void PoolingForwardCpuMax(const T * src, size_t channels, size_t srcH, size_t srcW, size_t kernelY, size_t kernelX,
-            size_t strideY, size_t strideX, size_t padY, size_t padX, T * dst, size_t dstH, size_t dstW, int trans)
+            size_t strideY, size_t strideX, size_t padY, size_t padX, T * dst, size_t dstH, size_t dstW, int trans, size_t dstY0, size_t dstY1)
         {
             if (trans)
             {
-                for (size_t ph = 0; ph < dstH; ++ph)
+                ParallelFor(dstY0, dstY1, 1, [=](size_t begin, size_t end)
                 {
-                    size_t hStart = ph * strideY - padY;
-                    size_t hEnd = std::min(hStart + kernelY, srcH);
-                    hStart = std::max<ptrdiff_t>(0, hStart);
-                    for (size_t pw = 0; pw < dstW; ++pw)
+                    for (size_t ph = begin; ph < end; ++ph)
                     {
-                        size_t wStart = pw * strideX - padX;
-                        size_t wEnd = std::min(wStart + kernelX, srcW);
-                        wStart = std::max<ptrdiff_t>(0, wStart);
-                        for (size_t c = 0; c < channels; ++c)
-                            dst[c] = T(-FLT_MAX);
-                        for (size_t h = hStart; h < hEnd; ++h)
+                        size_t hStart = ph * strideY - padY;
+                        size_t hEnd = std::min(hStart + kernelY, srcH);
+                        hStart = std::max<ptrdiff_t>(0, hStart);
+                        T * pd = dst + ph * dstW * channels;
+                        for (size_t pw = 0; pw < dstW; ++pw)
                         {
-                            for (size_t w = wStart; w < wEnd; ++w)
+                            size_t wStart = pw * strideX - padX;
+                            size_t wEnd = std::min(wStart + kernelX, srcW);
+                            wStart = std::max<ptrdiff_t>(0, wStart);
+                            for (size_t c = 0; c < channels; ++c)
+                                pd[c] = T(-FLT_MAX);
+                            for (size_t h = hStart; h < hEnd; ++h)
                             {
-                                const T * pc = src + (h * srcW + w)*channels;
-                                for (size_t c = 0; c < channels; ++c)
-                                    dst[c] = std::max(dst[c], pc[c]);
+                                for (size_t w = wStart; w < wEnd; ++w)
+                                {
+                                    const T * pc = src + (h * srcW + w)*channels;
+                                    for (size_t c = 0; c < channels; ++c)
+                                        pd[c] = std::max(pd[c], pc[c]);
+                                }
                             }
+                            pd += channels;
                         }
-                        dst += channels;
                     }
-                }
+                });
             }
             else
             {
-                for (size_t c = 0; c < channels; ++c)
+                ParallelFor(0, channels, 1, [=](size_t begin, size_t end)
                 {
-                    for (size_t ph = 0; ph < dstH; ++ph)
+                    for (size_t c = begin; c < end; ++c)
                     {
-                        size_t hStart = ph * strideY - padY;
-                        size_t hEnd = std::min(hStart + kernelY, srcH);
-                        hStart = std::max<ptrdiff_t>(0, hStart);
-                        for (size_t pw = 0; pw < dstW; ++pw)
+                        const T * ps = src + c * srcW * srcH;
+                        T * pd = dst + c * dstW * dstH;
+                        for (size_t ph = dstY0; ph < dstY1; ++ph)
                         {
-                            size_t wStart = pw * strideX - padX;
-                            size_t wEnd = std::min(wStart + kernelX, srcW);
-                            wStart = std::max<ptrdiff_t>(0, wStart);
-                            T max = T(-FLT_MAX);
-                            for (size_t h = hStart; h < hEnd; ++h)
-                                for (size_t w = wStart; w < wEnd; ++w)
-                                    max = std::max(max, src[h * srcW + w]);
-                            dst[ph*dstW + pw] = max;
+                            size_t hStart = ph * strideY - padY;
+                            size_t hEnd = std::min(hStart + kernelY, srcH);
+                            hStart = std::max<ptrdiff_t>(0, hStart);
+                            for (size_t pw = 0; pw < dstW; ++pw)
+                            {
+                                size_t wStart = pw * strideX - padX;
+                                size_t wEnd = std::min(wStart + kernelX, srcW);
+                                wStart = std::max<ptrdiff_t>(0, wStart);
+                                T max = T(-FLT_MAX);
+                                for (size_t h = hStart; h < hEnd; ++h)
+                                    for (size_t w = wStart; w < wEnd; ++w)
+                                        max = std::max(max, ps[h * srcW + w]);
+                                pd[ph*dstW + pw] = max;
+                            }
                         }
                     }
-                    src += srcW * srcH;
-                    dst += dstW * dstH;
-                }            
+                });
             }
         }
 
         template <class T> void PoolingForwardCpuAverage(const T * src, size_t channels, size_t srcH, size_t srcW, size_t kernelY, size_t kernelX,
-            size_t strideY, size_t strideX, size_t padY, size_t padX, T * dst, size_t dstH, size_t dstW, int trans)
+            size_t strideY, size_t strideX, size_t padY, size_t padX, T * dst, size_t dstH, size_t dstW, int trans, size_t dstY0, size_t dstY1)
         {
             if (trans)
             {
-                for (size_t ph = 0; ph < dstH; ++ph)
+                dst += dstY0 * dstW * channels;
+                for (size_t ph = dstY0; ph < dstY1; ++ph)
                 {
                     size_t hStart = ph * strideY - padY;
                     size_t hEnd = std::min(hStart + kernelY, srcH);
@@ -125,7 +133,7 @@ namespace Synet
             {
                 for (size_t c = 0; c < channels; ++c)
                 {
-                    for (size_t ph = 0; ph < dstH; ++ph)
+                    for (size_t ph = dstY0; ph < dstY1; ++ph)
                     {
                         size_t hStart = ph * strideY - padY;
                         size_t hEnd = std::min(hStart + kernelY, srcH);
@@ -228,12 +236,13 @@ namespace Synet
             _method = param.method();
             _yoloCompatible = param.yoloCompatible();
             _roundingType = param.roundingType();
-            assert(src[0]->Count() == 4);
+            _block = TensorFormatBlock(src[0]->Format());
+            assert(src[0]->Count() == (_block > 1 ? 5 : 4));
 
             _trans = src[0]->Format() == TensorFormatNhwc;
 
             _num = src[0]->Axis(0);
-            _channels = _trans ? src[0]->Axis(3) : src[0]->Axis(1);
+            _channels = _trans ? src[0]->Axis(3) : src[0]->Axis(1) * _block;
             _srcH = _trans ? src[0]->Axis(1) : src[0]->Axis(2);
             _srcW = _trans ? src[0]->Axis(2) : src[0]->Axis(3);
 
@@ -356,12 +365,33 @@ namespace Synet
                 }
             }
 
-            if(_trans)
+            if (_block > 1)
+                dst[0]->Reshape(Shape({ _num, _channels / _block, _dstH, _dstW, _block }), Type(), src[0]->Format());
+            else if(_trans)
                 dst[0]->Reshape(Shape({ _num, _dstH, _dstW , _channels}), Type(), TensorFormatNhwc);
             else
                 dst[0]->Reshape(Shape({ _num, _channels, _dstH, _dstW }), Type(), TensorFormatNchw);
         }
 
+        virtual bool RowWindow(size_t & kernel, size_t & stride, size_t & pad) const
+        {
+            kernel = _kernelY;
+            stride = _strideY;
+            pad = _padY;
+            return _trans && _block == 1 && _num == 1 && (_method == PoolingMethodTypeMax || _method == PoolingMethodTypeAverage);
+        }
+
+        virtual void ForwardRows(const TensorPtrs & src, const TensorPtrs & /*buf*/, const TensorPtrs & dst, size_t dstY0, size_t dstY1)
+        {
+            SYNET_PERF_FUNC();
+            if (_method == PoolingMethodTypeMax)
+                Detail::PoolingForwardCpuMax(src[0]->CpuData(), _channels, _srcH, _srcW, _kernelY, _kernelX, _strideY, _strideX, _padY, _padX, 
+                    dst[0]->CpuData(), _dstH, _dstW, _trans, dstY0, dstY1);
+            else
+                Detail::PoolingForwardCpuAverage(src[0]->CpuData(), _channels, _srcH, _srcW, _kernelY, _kernelX, _strideY, _strideX, _padY, _padX, 
+                    dst[0]->CpuData(), _dstH, _dstW, _trans, dstY0, dstY1);
+        }
+
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
@@ -370,6 +400,20 @@ namespace Synet
             const Type * pSrc = src[0]->CpuData();
             Type * pDst = dst[0]->CpuData();
             size_t dstSize = dst[0]->Size();
+            if (_block > 1)
+            {
+                assert(_yoloCompatible != 1);
+                for (size_t b = 0, blocks = _num * _channels / _block; b < blocks; ++b)
+                {
+                    if (_method == PoolingMethodTypeMax)
+                        Detail::PoolingForwardCpuMax(pSrc, _block, _srcH, _srcW, _kernelY, _kernelX, _strideY, _strideX, _padY, _padX, pDst, _dstH, _dstW, 1, 0, _dstH);
+                    else
+                        Detail::PoolingForwardCpuAverage(pSrc, _block, _srcH, _srcW, _kernelY, _kernelX, _strideY, _strideX, _padY, _padX, pDst, _dstH, _dstW, 1, 0, _dstH);
+                    pSrc += _block * _srcW * _srcH;
+                    pDst += _block * _dstW * _dstH;
+                }
+                return;
+            }
             switch (_method)
             {
             case PoolingMethodTypeMax:
@@ -377,33 +421,35 @@ namespace Synet
                 {
                     if (_trans)
                     {
-                        Detail::PoolingForwardCpuMax(pSrc, _channels, _srcH, _srcW, _kernelY, _kernelX, _strideY, _strideX, _padY, _padX, pDst, _dstH, _dstW, _trans);
+                        Detail::PoolingForwardCpuMax(pSrc, _channels, _srcH, _srcW, _kernelY, _kernelX, _strideY, _strideX, _padY, _padX, pDst, _dstH, _dstW, _trans, 0, _dstH);
                         pSrc += _channels*_srcW * _srcH;
-                        pDst += _channels*_srcW * _srcH;
+                        pDst += _channels*_dstW * _dstH;
                     }
                     else
                     {
-                        for (size_t c = 0; c < _channels; ++c)
+                        size_t srcW = _srcW, srcH = _srcH;
+                        if (_yoloCompatible == 1)
                         {
-                            size_t srcW = _srcW, srcH = _srcH;
-                            if (_yoloCompatible == 1)
-                            {
-                                srcH = _dstH*_strideY - _padY - _padH;
-                                srcW = _dstW*_strideX - _padX - _padW;
-                            }
-                            Detail::PoolingForwardMaxCpu(pSrc, _srcW, srcW, srcH, _kernelY, _kernelX, _padY, _padX, _strideY, _strideX, pDst, _dstW, _dstH);
-                            pSrc += _srcW * _srcH;
-                            pDst += _dstW * _dstH;
+                            srcH = _dstH*_strideY - _padY - _padH;
+                            srcW = _dstW*_strideX - _padX - _padW;
                         }
+                        ParallelFor(0, _channels, 1, [=](size_t begin, size_t end)
+                        {
+                            for (size_t c = begin; c < end; ++c)
+                                Detail::PoolingForwardMaxCpu(pSrc + c * _srcW * _srcH, _srcW, srcW, srcH, _kernelY, _kernelX, 
+                                    _padY, _padX, _strideY, _strideX, pDst + c * _dstW * _dstH, _dstW, _dstH);
+                        });
+                        pSrc += _channels * _srcW * _srcH;
+                        pDst += _channels * _dstW * _dstH;
                     }
                 }
                 break;
             case PoolingMethodTypeAverage:
                 for (size_t n = 0; n < _num; ++n)
                 {
-                    Detail::PoolingForwardCpuAverage(pSrc, _channels, _srcH, _srcW, _kernelY, _kernelX, _strideY, _strideX, _padY, _padX, pDst, _dstH, _dstW, _trans);
+                    Detail::PoolingForwardCpuAverage(pSrc, _channels, _srcH, _srcW, _kernelY, _kernelX, _strideY, _strideX, _padY, _padX, pDst, _dstH, _dstW, _trans, 0, _dstH);
                     pSrc += _channels*_srcW * _srcH;
-                    pDst += _channels*_srcW * _srcH;
+                    pDst += _channels*_dstW * _dstH;
                 }
                 break;
             case PoolingMethodTypeStochastic:
@@ -418,6 +464,6 @@ namespace Synet
         PoolingMethodType _method;
         RoundingType _roundingType;
         int _yoloCompatible, _trans;
-        size_t _num, _channels, _srcH, _srcW, _kernelY, _kernelX, _strideX, _strideY, _padX, _padY, _padW, _padH, _dstH, _dstW;
+        size_t _block, _num, _channels, _srcH, _srcW, _kernelY, _kernelX, _strideX, _strideY, _padX, _padY, _padW, _padH, _dstH, _dstW;
     };
 }
\ No newline at end of file
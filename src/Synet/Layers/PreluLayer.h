@@ -80,10 +80,11 @@ namespace Synet
         {
             assert(this->Weight().size() == 1);
             _count = this->Weight()[0].Size();
-            assert(_count == 1 || _count == src[0]->Axis(1));
+            _block = _count > 1 ? TensorFormatBlock(src[0]->Format()) : 1;
+            assert(_count == 1 || _count == src[0]->Axis(1) * _block);
             _size = src[0]->Size() / _count;
             assert(_size*_count == src[0]->Size());
-            dst[0]->Reshape(src[0]->Shape());
+            dst[0]->Reshape(src[0]->Shape(), Type(), src[0]->Format());
         }
 
     protected:
@@ -91,10 +92,16 @@ namespace Synet
         {
             SYNET_PERF_FUNC();
 
-            Detail::PreluLayerForwardCpu(src[0]->CpuData(), this->Weight()[0].CpuData(), _count, _size, dst[0]->CpuData(), 0);
+            if (_block > 1)
+            {
+                for (size_t c = 0; c < _count; c += _block)
+                    Detail::PreluLayerForwardCpu(src[0]->CpuData() + c * _size, this->Weight()[0].CpuData() + c, _block, _size, dst[0]->CpuData() + c * _size, 1);
+            }
+            else
+                Detail::PreluLayerForwardCpu(src[0]->CpuData(), this->Weight()[0].CpuData(), _count, _size, dst[0]->CpuData(), 0);
         }
 
     private:
-        size_t _count, _size;
+        size_t _count, _size, _block;
     };
 }
\ No newline at end of file
@@ -48,6 +48,20 @@ namespace Synet
             dst[0]->Reshape(src[0]->Shape(), Type(), src[0]->Format());
         }
 
+        virtual bool RowWindow(size_t & kernel, size_t & stride, size_t & pad) const
+        {
+            kernel = 1;
+            stride = 1;
+            pad = 0;
+            return true;
+        }
+
+        virtual void ForwardRows(const TensorPtrs & src, const TensorPtrs & /*buf*/, const TensorPtrs & dst, size_t dstY0, size_t dstY1)
+        {
+            size_t row = dst[0]->Size(2);
+            CpuRelu<Type>(src[0]->CpuData() + dstY0 * row, (dstY1 - dstY0) * row, _negativeSlope, dst[0]->CpuData() + dstY0 * row);
+        }
+
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
@@ -0,0 +1,127 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Synet/Common.h"
+#include "Synet/Layer.h"
+
+namespace Synet
+{
+    namespace Detail
+    {
+        template <class T> void ReorderNchwToBlocked(const T * src, size_t channels, size_t spatial, size_t block, T * dst)
+        {
+            ParallelFor(0, channels / block, 1, [=](size_t begin, size_t end)
+            {
+                for (size_t cb = begin; cb < end; ++cb)
+                {
+                    const T * ps = src + cb * block * spatial;
+                    T * pd = dst + cb * spatial * block;
+                    for (size_t i = 0; i < spatial; ++i, pd += block)
+                        for (size_t b = 0; b < block; ++b)
+                            pd[b] = ps[b * spatial + i];
+                }
+            });
+        }
+
+        template <class T> void ReorderBlockedToNchw(const T * src, size_t channels, size_t spatial, size_t block, T * dst)
+        {
+            ParallelFor(0, channels / block, 1, [=](size_t begin, size_t end)
+            {
+                for (size_t cb = begin; cb < end; ++cb)
+                {
+                    const T * ps = src + cb * spatial * block;
+                    T * pd = dst + cb * block * spatial;
+                    for (size_t i = 0; i < spatial; ++i, ps += block)
+                        for (size_t b = 0; b < block; ++b)
+                            pd[b * spatial + i] = ps[b];
+                }
+            });
+        }
+    }
+
+    template <class T> class ReorderLayer : public Synet::Layer<T>
+    {
+    public:
+        typedef T Type;
+        typedef Layer<T> Base;
+        typedef typename Base::TensorPtrs TensorPtrs;
+
+        ReorderLayer(const LayerParam & param)
+            : Base(param)
+        {
+        }
+
+        virtual void Reshape(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
+        {
+            TensorFormat format = this->Param().reorder().format();
+            size_t srcBlock = TensorFormatBlock(src[0]->Format());
+            size_t dstBlock = TensorFormatBlock(format);
+            _block = 1;
+            if (srcBlock > 1 && format == TensorFormatNchw)
+            {
+                assert(src[0]->Count() == 5);
+                _block = srcBlock;
+                _num = src[0]->Axis(0);
+                _channels = src[0]->Axis(1) * srcBlock;
+                _spatial = src[0]->Axis(2) * src[0]->Axis(3);
+                dst[0]->Reshape(Shape({ _num, _channels, src[0]->Axis(2), src[0]->Axis(3) }), Type(), TensorFormatNchw);
+            }
+            else if (srcBlock == 1 && dstBlock > 1 && src[0]->Format() == TensorFormatNchw && src[0]->Count() == 4 && src[0]->Axis(1) % dstBlock == 0)
+            {
+                _block = dstBlock;
+                _num = src[0]->Axis(0);
+                _channels = src[0]->Axis(1);
+                _spatial = src[0]->Axis(2) * src[0]->Axis(3);
+                dst[0]->Reshape(Shape({ _num, _channels / dstBlock, src[0]->Axis(2), src[0]->Axis(3), dstBlock }), Type(), format);
+            }
+            else
+                dst[0]->Share(*src[0]);
+        }
+
+    protected:
+        virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
+        {
+            SYNET_PERF_FUNC();
+            if (_block == 1)
+                return;
+            const Type * pSrc = src[0]->CpuData();
+            Type * pDst = dst[0]->CpuData();
+            for (size_t n = 0; n < _num; ++n)
+            {
+                if (dst[0]->Format() == TensorFormatNchw)
+                    Detail::ReorderBlockedToNchw(pSrc, _channels, _spatial, _block, pDst);
+                else
+                    Detail::ReorderNchwToBlocked(pSrc, _channels, _spatial, _block, pDst);
+                pSrc += _channels * _spatial;
+                pDst += _channels * _spatial;
+            }
+        }
+
+    private:
+        size_t _block, _num, _channels, _spatial;
+    };
+}
@@ -39,47 +39,53 @@ namespace Synet
             {
                 if(trans)
                 {
-                    for (size_t j = 0; j < height; ++j)
+                    ParallelFor(0, height, 1, [=](size_t begin, size_t end)
                     {
-                        for (size_t i = 0; i < width; ++i)
+                        for (size_t j = begin; j < end; ++j)
                         {
-                            for (size_t k = 0; k < channels; ++k)
+                            for (size_t i = 0; i < width; ++i)
                             {
-                                size_t src_index = k + channels*(i + width*(j + height*b));
-                                size_t c2 = k % out_c;
-                                size_t offset = k / out_c;
-                                size_t w2 = i*stride + offset % stride;
-                                size_t h2 = j*stride + offset / stride;
-                                size_t dst_index = c2 + out_c*(w2 + width*stride*(h2 + height*stride*b));
-                                if (forward)
-                                    dst[dst_index] = src[src_index];
-                                else
-                                    dst[src_index] = src[dst_index];
+                                for (size_t k = 0; k < channels; ++k)
+                                {
+                                    size_t src_index = k + channels*(i + width*(j + height*b));
+                                    size_t c2 = k % out_c;
+                                    size_t offset = k / out_c;
+                                    size_t w2 = i*stride + offset % stride;
+                                    size_t h2 = j*stride + offset / stride;
+                                    size_t dst_index = c2 + out_c*(w2 + width*stride*(h2 + height*stride*b));
+                                    if (forward)
+                                        dst[dst_index] = src[src_index];
+                                    else
+                                        dst[src_index] = src[dst_index];
+                                }
                             }
                         }
-                    }
+                    });
                 }
                 else
                 {
-                    for (size_t k = 0; k < channels; ++k)
+                    ParallelFor(0, channels, 1, [=](size_t begin, size_t end)
                     {
-                        for (size_t j = 0; j < height; ++j)
+                        for (size_t k = begin; k < end; ++k)
                         {
-                            for (size_t i = 0; i < width; ++i)
+                            for (size_t j = 0; j < height; ++j)
                             {
-                                size_t src_index = i + width*(j + height*(k + channels*b));
-                                size_t c2 = k % out_c;
-                                size_t offset = k / out_c;
-                                size_t w2 = i*stride + offset % stride;
-                                size_t h2 = j*stride + offset / stride;
-                                size_t dst_index = w2 + width*stride*(h2 + height*stride*(c2 + out_c*b));
-                                if (forward) 
-                                    dst[dst_index] = src[src_index];
-                                else 
-                                    dst[src_index] = src[dst_index];
+                                for (size_t i = 0; i < width; ++i)
+                                {
+                                    size_t src_index = i + width*(j + height*(k + channels*b));
+                                    size_t c2 = k % out_c;
+                                    size_t offset = k / out_c;
+                                    size_t w2 = i*stride + offset % stride;
+                                    size_t h2 = j*stride + offset / stride;
+                                    size_t dst_index = w2 + width*stride*(h2 + height*stride*(c2 + out_c*b));
+                                    if (forward) 
+                                        dst[dst_index] = src[src_index];
+                                    else 
+                                        dst[src_index] = src[dst_index];
+                                }
                             }
                         }
-                    }
+                    });
                 }
             }
         }
@@ -107,6 +107,8 @@ namespace Synet
             const Tensor & scale = this->Weight()[0];
             _count = scale.Size();
             _trans = src[0]->Format() == TensorFormatNhwc;
+            _block = TensorFormatBlock(src[0]->Format());
+            assert(_block == 1 || _count % _block == 0);
             if (scale.Size() == src[0]->Size())
             {
                 _num = 1;
@@ -132,14 +134,20 @@ namespace Synet
             Type * pDst = dst[0]->CpuData();
             for (size_t n = 0; n < _num; ++n)
             {
-                Detail::ScaleLayerForwardCpu(pSrc, pScale, pBias, _count, _size, pDst, _trans);
+                if (_block > 1)
+                {
+                    for (size_t c = 0; c < _count; c += _block)
+                        Detail::ScaleLayerForwardCpu(pSrc + c * _size, pScale + c, pBias ? pBias + c : NULL, _block, _size, pDst + c * _size, 1);
+                }
+                else
+                    Detail::ScaleLayerForwardCpu(pSrc, pScale, pBias, _count, _size, pDst, _trans);
                 pSrc += _count*_size;
                 pDst += _count*_size;
             }
         }
 
     private:
-        size_t _axis, _num, _count, _size;
+        size_t _axis, _num, _count, _size, _block;
         int _trans;
         bool _biasTerm;
     };
@@ -49,14 +49,14 @@ namespace Synet
 
             assert(src.size() == 2 && src[0]->Shape() == src[1]->Shape());
             dst[0]->Reshape(src[0]->Shape(), Type(), src[0]->Format());
-            _src[0] = src[0]->CpuData();
-            _src[1] = src[1]->CpuData();
         }
 
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
             SYNET_PERF_FUNC();
+            _src[0] = src[0]->CpuData();
+            _src[1] = src[1]->CpuData();
             Detail::EltwiseLayerForwardCpu(_src, _coeff, 2, dst[0]->Size(), EltwiseOperationTypeSum, dst[0]->CpuData());
         }
     private:
@@ -42,6 +42,11 @@ namespace Synet
         {
         }
 
+        bool Contiguous() const
+        {
+            return _numSlices == 1;
+        }
+
         virtual void Reshape(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
             const SliceParam & param = this->Param().slice();
@@ -104,7 +109,8 @@ namespace Synet
                 {
                     size_t dstOffset = n * dstSliceAxis * _sliceSize;
                     size_t srcOffset = (n * srcSliceAxis + offsetSliceAxis) * _sliceSize;
-                    CpuCopy(pSrc + srcOffset, dstSliceAxis * _sliceSize, pDst + dstOffset);
+                    if (pSrc + srcOffset != pDst + dstOffset)
+                        CpuCopy(pSrc + srcOffset, dstSliceAxis * _sliceSize, pDst + dstOffset);
                 }
                 offsetSliceAxis += dstSliceAxis;
             }
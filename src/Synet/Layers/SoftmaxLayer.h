@@ -95,6 +95,11 @@ namespace Synet
             _scale.Reshape(scaleShape);
         }
 
+        virtual size_t MemoryUsage() const
+        {
+            return _scale.Size() * sizeof(Type);
+        }
+
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
@@ -102,8 +107,14 @@ namespace Synet
 
             size_t channels = src[0]->Axis(_softmaxAxis);
             size_t dim = src[0]->Size() / _outerNum;
-            for (size_t i = 0; i < _outerNum; ++i)
-                Detail::SoftmaxLayerForwardCpu(src[0]->CpuData() + i*dim, channels, _innerNum, _scale.CpuData(), dst[0]->CpuData() + i*dim);
+            const Type * pSrc = src[0]->CpuData();
+            Type * pBuf = _scale.CpuData();
+            Type * pDst = dst[0]->CpuData();
+            ParallelFor(0, _outerNum, std::max<size_t>(1, 1024 / dim), [=](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                    Detail::SoftmaxLayerForwardCpu(pSrc + i*dim, channels, _innerNum, pBuf + i*_innerNum, pDst + i*dim);
+            });
         }
 
     private:
@@ -41,6 +41,11 @@ namespace Synet
         {
         }
 
+        bool Contiguous() const
+        {
+            return _outer == 1;
+        }
+
         virtual void Reshape(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
             const UnpackParam & param = this->Param().unpack();
@@ -78,7 +83,8 @@ namespace Synet
                     {
                         const Type * pSrc = src[0]->CpuData() + (_count*o + c)*_step*_inner;
                         Type * pDst = dst[c]->CpuData() + o*_step*_inner;
-                        CpuCopy(pSrc, _inner*_step, pDst);
+                        if (pSrc != pDst)
+                            CpuCopy(pSrc, _inner*_step, pDst);
                     }
                 }
             }
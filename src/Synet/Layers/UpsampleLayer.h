@@ -122,9 +122,10 @@ namespace Synet
             }
             _scale = param.scale();
             _trans = src[0]->Format() == TensorFormatNhwc;
+            _block = TensorFormatBlock(src[0]->Format());
 
             Shape shape = src[0]->Shape();
-            assert(shape.size() == 4);
+            assert(shape.size() == (_block > 1 ? 5 : 4));
             _num = shape[0];
             if (_trans)
             {
@@ -144,7 +145,7 @@ namespace Synet
             }
             else
             {
-                _channel = shape[1];
+                _channel = shape[1] * _block;
                 _height = shape[2];
                 _width = shape[3];
                 if (_reverse)
@@ -165,12 +166,19 @@ namespace Synet
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
             SYNET_PERF_FUNC();
-            Detail::UpsampleLayerForwardCpu(src[0]->CpuData(), _channel, _height, _width, _stride, _scale, _reverse, _trans, dst[0]->CpuData());
+            if (_block > 1)
+            {
+                size_t blocks = _num * _channel / _block, srcSize = src[0]->Size() / blocks, dstSize = dst[0]->Size() / blocks;
+                for (size_t b = 0; b < blocks; ++b)
+                    Detail::UpsampleLayerForwardCpu(src[0]->CpuData() + b * srcSize, _block, _height, _width, _stride, _scale, _reverse, 1, dst[0]->CpuData() + b * dstSize);
+            }
+            else
+                Detail::UpsampleLayerForwardCpu(src[0]->CpuData(), _channel, _height, _width, _stride, _scale, _reverse, _trans, dst[0]->CpuData());
         }
 
     private:
         int _reverse, _trans;
-        size_t _stride, _num, _channel, _height, _width;
+        size_t _stride, _num, _channel, _height, _width, _block;
         float _scale;
     };
 }
\ No newline at end of file
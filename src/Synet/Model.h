@@ -0,0 +1,357 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Synet/Common.h"
+#include "Synet/Tensor.h"
+#include "Synet/Params.h"
+#include "Synet/Layer.h"
+#include "Synet/Utils/FileMap.h"
+#include "Synet/Utils/WeightFile.h"
+
+namespace Synet
+{
+    template <class T> class Model
+    {
+    public:
+        typedef T Type;
+        typedef Synet::Tensor<T> Tensor;
+        typedef std::vector<Tensor> Tensors;
+        typedef typename Synet::Layer<T>::CachePtr CachePtr;
+
+        Model()
+            : _empty(true)
+        {
+        }
+
+        bool Empty() const
+        {
+            return _empty;
+        }
+
+        const NetworkParam & Param() const
+        {
+            return _param();
+        }
+
+        const Tensors & Weight(size_t layer) const
+        {
+            return _weight[layer];
+        }
+
+        const Tensors & State(size_t layer) const
+        {
+            return _state[layer];
+        }
+
+        const CachePtr & Cache(size_t layer) const
+        {
+            return _cache[layer];
+        }
+
+        bool Load(const String & param, const String & weight, bool mapping = false)
+        {
+            _empty = true;
+            _weight.clear();
+            _state.clear();
+            if (!_param.Load(param))
+                return false;
+            if (mapping ? !MapWeight(weight) : !ReadWeight(weight))
+            {
+                _weight.clear();
+                _state.clear();
+                return false;
+            }
+            ResetCache();
+            _empty = false;
+            return true;
+        }
+
+        bool Reorder(const TensorFormat & format)
+        {
+            if (_empty || TensorFormatBlock(format) == 1 || _param().target().size())
+                return false;
+            const LayerParams & src = _param().layers();
+            for (size_t i = 0; i < src.size(); ++i)
+            {
+                if (src[i].type() != LayerTypeInput)
+                    continue;
+                for (size_t j = 0; j < src[i].input().shape().size(); ++j)
+                    if (src[i].input().shape()[j].format() != TensorFormatNchw)
+                        return false;
+            }
+
+            LayerParams dst;
+            std::vector<Tensors> weight;
+            NameSet names, stale, consumed;
+            NameMap blocked, plain, logical;
+            for (size_t i = 0; i < src.size(); ++i)
+            {
+                LayerParam layer = src[i];
+                if (Blocked(layer))
+                {
+                    for (size_t j = 0; j < layer.src().size(); ++j)
+                    {
+                        String name = layer.src()[j];
+                        if (blocked.find(name) == blocked.end())
+                        {
+                            blocked[name] = Unique(name + "@" + ValueToString(format), names);
+                            logical[blocked[name]] = name;
+                            AddReorder(Current(plain, name), blocked[name], format, dst, weight);
+                        }
+                        layer.src()[j] = blocked[name];
+                    }
+                    for (size_t j = 0; j < layer.dst().size(); ++j)
+                    {
+                        String name = layer.dst()[j];
+                        if (j >= src[i].src().size() || name != src[i].src()[j])
+                        {
+                            blocked[name] = Unique(name + "@" + ValueToString(format), names);
+                            logical[blocked[name]] = name;
+                        }
+                        if (layer.name() == name)
+                            layer.name() = blocked[name];
+                        layer.dst()[j] = blocked[name];
+                        stale.insert(name);
+                    }
+                    if (layer.type() == LayerTypeConvolution)
+                        layer.convolution().format() = format;
+                }
+                else
+                {
+                    for (size_t j = 0; j < layer.src().size(); ++j)
+                    {
+                        String name = layer.src()[j];
+                        if (stale.find(name) != stale.end())
+                        {
+                            plain[name] = Unique(name, names);
+                            AddReorder(blocked[name], plain[name], TensorFormatNchw, dst, weight);
+                            stale.erase(name);
+                        }
+                        layer.src()[j] = Current(plain, name);
+                    }
+                    for (size_t j = 0; j < layer.dst().size(); ++j)
+                    {
+                        String name = layer.dst()[j];
+                        if (j < src[i].src().size() && name == src[i].src()[j])
+                            layer.dst()[j] = layer.src()[j];
+                        else
+                        {
+                            names.insert(name);
+                            plain.erase(name);
+                        }
+                        blocked.erase(name);
+                        stale.erase(name);
+                    }
+                }
+                dst.push_back(layer);
+                weight.push_back(_weight[i]);
+            }
+
+            for (size_t i = 0; i < dst.size(); ++i)
+                for (size_t j = 0; j < dst[i].src().size(); ++j)
+                    consumed.insert(dst[i].src()[j]);
+            _param().layers().clear();
+            _weight.clear();
+            for (size_t i = 0; i < dst.size(); ++i)
+            {
+                _param().layers().push_back(dst[i]);
+                _weight.push_back(weight[i]);
+                for (size_t j = 0; j < dst[i].dst().size(); ++j)
+                {
+                    const String & name = dst[i].dst()[j];
+                    if (logical.find(name) != logical.end() && consumed.insert(name).second)
+                        AddReorder(name, Unique(logical[name], names), TensorFormatNchw, _param().layers(), _weight);
+                }
+            }
+            _state.assign(_weight.size(), Tensors());
+            ResetCache();
+            return true;
+        }
+
+    private:
+        typedef std::vector<LayerParam> LayerParams;
+        typedef std::set<String> NameSet;
+        typedef std::map<String, String> NameMap;
+
+        void ResetCache()
+        {
+            _cache.resize(_weight.size());
+            for (size_t i = 0; i < _cache.size(); ++i)
+                _cache[i] = std::make_shared<typename Synet::Layer<T>::Cache>();
+        }
+
+        bool ReadWeight(const String & path)
+        {
+            std::ifstream ifs(path.c_str(), std::ifstream::binary);
+            if (!ifs.is_open())
+                return false;
+            WeightFileHeader header;
+            size_t alignment, offset;
+            ifs.read((char*)&header, sizeof(header));
+            if (!ReadWeightFileHeader(&header, (size_t)ifs.gcount(), alignment, offset))
+                return false;
+            ifs.clear();
+            ifs.seekg(offset);
+            const LayerParams & layers = _param().layers();
+            _weight.resize(layers.size());
+            _state.resize(layers.size());
+            for (size_t i = 0; i < layers.size(); ++i)
+            {
+                if (!ReadTensors(ifs, layers[i].weight(), alignment, offset, _weight[i]))
+                    return false;
+                if (!ReadTensors(ifs, layers[i].state(), alignment, offset, _state[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        static bool ReadTensors(std::istream & is, const std::vector<ShapeParam> & params, size_t alignment, size_t & offset, Tensors & tensors)
+        {
+            tensors.resize(params.size());
+            for (size_t i = 0; i < tensors.size(); ++i)
+            {
+                Tensor & tensor = tensors[i];
+                tensor.Reshape(params[i].dim(), Type(), params[i].format());
+                size_t aligned = WeightFileOffset(offset, alignment);
+                if (aligned != offset)
+                    is.seekg(aligned);
+                if (!is.read((char*)tensor.CpuData(), tensor.Size() * sizeof(T)))
+                    return false;
+                offset = aligned + tensor.Size() * sizeof(T);
+            }
+            return true;
+        }
+
+        bool MapWeight(const String & path)
+        {
+            std::shared_ptr<FileMap> file = std::make_shared<FileMap>();
+            if (!file->Open(path))
+                return ReadWeight(path);
+            size_t alignment, offset;
+            if (!ReadWeightFileHeader(file->Data(), file->Size(), alignment, offset))
+                return false;
+            const LayerParams & layers = _param().layers();
+            _weight.resize(layers.size());
+            _state.resize(layers.size());
+            for (size_t i = 0; i < layers.size(); ++i)
+            {
+                if (!MapTensors(file, layers[i].weight(), alignment, offset, _weight[i]))
+                    return false;
+                if (!MapTensors(file, layers[i].state(), alignment, offset, _state[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        static bool MapTensors(const std::shared_ptr<FileMap> & file, const std::vector<ShapeParam> & params, size_t alignment, size_t & offset, Tensors & tensors)
+        {
+            tensors.resize(params.size());
+            for (size_t i = 0; i < tensors.size(); ++i)
+            {
+                Tensor & tensor = tensors[i];
+                offset = WeightFileOffset(offset, alignment);
+                tensor.Attach(params[i].dim(), params[i].format(), (const Type*)(file->Data() + offset), file);
+                offset += tensor.Size() * sizeof(T);
+                if (offset > file->Size())
+                    return false;
+            }
+            return true;
+        }
+
+        static bool Blocked(const LayerParam & layer)
+        {
+            switch (layer.type())
+            {
+            case LayerTypeBatchNorm:
+                return layer.batchNorm().useGlobalStats() && layer.weight().size() >= 2 && layer.weight()[0].dim().size() == 1;
+            case LayerTypeBias:
+                return layer.bias().axis() == 1 && layer.src().size() == 1 && layer.weight().size() == 1 && layer.weight()[0].dim().size() == 1;
+            case LayerTypeConcat:
+                return layer.concat().axis() == 1;
+            case LayerTypeConvolution:
+            {
+                const ConvolutionParam & param = layer.convolution();
+                if (param.axis() != 1 || layer.weight().empty() || layer.weight()[0].dim().size() != 4 || layer.weight()[0].format() != TensorFormatNchw)
+                    return false;
+                return param.group() == 1 || (param.group() == param.outputNum() && layer.weight()[0].dim()[1] == 1);
+            }
+            case LayerTypeEltwise:
+                return true;
+            case LayerTypeFused:
+                return layer.fused().type() >= 0 && layer.fused().type() <= 3;
+            case LayerTypePointwise:
+                return true;
+            case LayerTypePooling:
+                return (layer.pooling().method() == PoolingMethodTypeMax || layer.pooling().method() == PoolingMethodTypeAverage) && layer.pooling().yoloCompatible() != 1;
+            case LayerTypePrelu:
+                return layer.weight().size() == 1 && layer.weight()[0].dim().size() == 1;
+            case LayerTypeRelu:
+                return true;
+            case LayerTypeScale:
+                return layer.scale().axis() == 1 && layer.weight().size() && layer.weight()[0].dim().size() == 1;
+            case LayerTypeSigmoid:
+                return true;
+            case LayerTypeUpsample:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        static String Unique(const String & name, NameSet & names)
+        {
+            String unique = name;
+            for (size_t i = 1; names.find(unique) != names.end(); ++i)
+                unique = name + "@" + ValueToString(i);
+            names.insert(unique);
+            return unique;
+        }
+
+        static String Current(const NameMap & plain, const String & name)
+        {
+            NameMap::const_iterator it = plain.find(name);
+            return it == plain.end() ? name : it->second;
+        }
+
+        static void AddReorder(const String & src, const String & dst, const TensorFormat & format, LayerParams & layers, std::vector<Tensors> & weight)
+        {
+            LayerParam layer;
+            layer.type() = LayerTypeReorder;
+            layer.name() = dst;
+            layer.src().push_back(src);
+            layer.dst().push_back(dst);
+            layer.reorder().format() = format;
+            layers.push_back(layer);
+            weight.push_back(Tensors());
+        }
+
+        bool _empty;
+        NetworkParamHolder _param;
+        std::vector<Tensors> _weight, _state;
+        std::vector<CachePtr> _cache;
+    };
+}
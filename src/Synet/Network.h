@@ -24,6 +24,9 @@
 
 #pragma once
 
+#include "Synet/Model.h"
+#include "Synet/Utils/ThreadPool.h"
+
 #include "Synet/Layers/BatchNormLayer.h"
 #include "Synet/Layers/BiasLayer.h"
 #include "Synet/Layers/BinaryOperationLayer.h"
@@ -47,12 +50,14 @@
 #include "Synet/Layers/NormalizeLayer.h"
 #include "Synet/Layers/PadLayer.h"
 #include "Synet/Layers/PermuteLayer.h"
+#include "Synet/Layers/PointwiseLayer.h"
 #include "Synet/Layers/PoolingLayer.h"
 #include "Synet/Layers/PreluLayer.h"
 #include "Synet/Layers/PriorBoxLayer.h"
 #include "Synet/Layers/ReductionLayer.h"
 #include "Synet/Layers/RegionLayer.h"
 #include "Synet/Layers/ReluLayer.h"
+#include "Synet/Layers/ReorderLayer.h"
 #include "Synet/Layers/ReorgLayer.h"
 #include "Synet/Layers/ReshapeLayer.h"
 #include "Synet/Layers/RestrictRangeLayer.h"
@@ -77,6 +82,8 @@ namespace Synet
         typedef T Type;
         typedef Synet::Tensor<T> Tensor;
         typedef std::vector<Tensor*> TensorPtrs;
+        typedef Synet::Model<T> Model;
+        typedef std::shared_ptr<Model> ModelPtr;
         typedef Synet::Layer<T> Layer;
         typedef Layer * LayerPtr;
         typedef std::vector<LayerPtr> LayerPtrs;
@@ -85,6 +92,11 @@ namespace Synet
 
         Network()
             : _empty(true)
+            , _memoryPlan(true)
+            , _zeroCopy(true)
+            , _weightMapping(false)
+            , _tileCache(0)
+            , _planCache(0)
         {
         }
 
@@ -95,36 +107,69 @@ namespace Synet
 
         const NetworkParam & Param() const 
         { 
-            return _param(); 
+            return _model->Param(); 
+        }
+
+        const ModelPtr & GetModel() const
+        {
+            return _model;
         }
 
         bool Load(const String & param, const String & weight)
         {
-            if (!_param.Load(param))
+            ModelPtr model(new Model());
+            if (!model->Load(param, weight, _weightMapping))
                 return false;
+            return Load(model);
+        }
 
-            _layers.clear();
-            for (size_t i = 0; i < _param().layers().size(); ++i)
-            {
-                LayerSharedPtr layer(Create(_param().layers()[i]));
-                if (layer)
-                    _layers.push_back(layer);
-            }
+        bool Load(const ModelPtr & model)
+        {
+            if (!model || model->Empty())
+                return false;
 
-            std::ifstream ifs(weight.c_str(), std::ifstream::binary);
-            if (!ifs.is_open())
+            _empty = true;
+            _model = model;
+            _plans.clear();
+            CreateLayers();
+            return Init();
+        }
+
+        bool Compile(const String & param, const String & weight) const
+        {
+            if (_empty)
                 return false;
+            NetworkParamHolder compiled;
+            compiled() = Param();
+            std::vector<LayerParam> & layers = compiled().layers();
+            for (size_t i = 0; i < _input.size(); ++i)
+            {
+                InputParam & input = layers[LayerIndex(_input[i].layer)].input();
+                if (input.shape().size() != _input[i].dst.size())
+                    continue;
+                for (size_t j = 0; j < _input[i].dst.size(); ++j)
+                    input.shape()[j].dim() = _input[i].dst[j]->Shape();
+            }
+            std::vector<Tensors> state(layers.size());
             for (size_t i = 0; i < _layers.size(); ++i)
             {
-                if (!_layers[i]->Load(ifs))
+                size_t index = LayerIndex(_layers[i].get());
+                _layers[i]->Compile(layers[index], state[index]);
+            }
+            Tensors tensors;
+            for (size_t i = 0; i < layers.size(); ++i)
+            {
+                layers[i].state().resize(state[i].size());
+                for (size_t j = 0; j < state[i].size(); ++j)
                 {
-                    ifs.close();
-                    return false;
+                    layers[i].state()[j].dim() = state[i][j].Shape();
+                    layers[i].state()[j].format() = state[i][j].Format();
                 }
+                tensors.insert(tensors.end(), _model->Weight(i).begin(), _model->Weight(i).end());
+                tensors.insert(tensors.end(), state[i].begin(), state[i].end());
             }
-            ifs.close();
-
-            return Init();
+            compiled().target() = Target();
+            return compiled.SaveBinary(param) && SaveWeight(tensors, weight);
         }
 
         TensorPtrs & Src() 
@@ -142,13 +187,93 @@ namespace Synet
             return _back;
         }
 
+        bool MemoryPlan() const
+        {
+            return _memoryPlan;
+        }
+
+        void SetMemoryPlan(bool enable)
+        {
+            _memoryPlan = enable;
+            _plans.clear();
+        }
+
+        bool ZeroCopy() const
+        {
+            return _zeroCopy;
+        }
+
+        void SetZeroCopy(bool enable)
+        {
+            _zeroCopy = enable;
+            _plans.clear();
+        }
+
+        bool WeightMapping() const
+        {
+            return _weightMapping;
+        }
+
+        void SetWeightMapping(bool enable)
+        {
+            _weightMapping = enable;
+        }
+
+        size_t TileCache() const
+        {
+            return _tileCache;
+        }
+
+        void SetTileCache(size_t size)
+        {
+            _tileCache = size;
+            _plans.clear();
+        }
+
+        size_t PlanCache() const
+        {
+            return _planCache;
+        }
+
+        void SetPlanCache(size_t size)
+        {
+            _planCache = size;
+            TrimPlans();
+        }
+
+        size_t ThreadNumber() const
+        {
+            return _pool ? _pool->Size() : 1;
+        }
+
+        void SetThreadNumber(size_t interOp, size_t intraOp)
+        {
+            Synet::SetThreadNumber(intraOp);
+            if (interOp > 1)
+            {
+                if (!_pool)
+                    _pool.reset(new ThreadPool());
+                _pool->Resize(interOp);
+            }
+            else
+                _pool.reset();
+            _plans.clear();
+            for (size_t i = 0; i < _stages.size(); ++i)
+                _stages[i].signature.clear();
+            if (!_empty)
+                Schedule();
+        }
+
         bool Reshape(const Strings & srcNames = Strings(), const Shapes & srcShapes = Shapes(), const Strings & dstNames = Strings())
         {
             if (srcNames.size() != srcShapes.size())
                 return false;
 
-            for (size_t i = 0; i < _tensors.size(); ++i)
-                _tensors[i]->Clear();
+            String key = PlanKey(srcNames, srcShapes, dstNames);
+            if (SwitchPlan(key))
+                return true;
+
+            ReleaseMemory();
 
             if (srcNames.size())
             {
@@ -189,8 +314,7 @@ namespace Synet
                     _input[i].layer->Reshape(_input[i].src, _input[i].buf, _input[i].dst);
             }
 
-            for (size_t i = 0; i < _stages.size(); ++i)
-                _stages[i].layer->Reshape(_stages[i].src, _stages[i].buf, _stages[i].dst);
+            ReshapeStages();
 
             if (dstNames.size())
             {
@@ -213,6 +337,10 @@ namespace Synet
                 }
             }
 
+            PlanMemory();
+            Schedule();
+            _planKey = key;
+            TrimPlans();
             return true;
         }
 
@@ -243,9 +371,16 @@ namespace Synet
             }
             else
                 return false;
+            String key = PlanKey(Strings(1, param.name()), Shapes(1, shape), Strings());
+            if (SwitchPlan(key))
+                return true;
+            ReleaseMemory();
             _input[0].dst[0]->Reshape(shape, Type(0), format);
-            for (size_t i = 0; i < _stages.size(); ++i)
-                _stages[i].layer->Reshape(_stages[i].src, _stages[i].buf, _stages[i].dst);
+            ReshapeStages();
+            PlanMemory();
+            Schedule();
+            _planKey = key;
+            TrimPlans();
             return true;
         }
 
@@ -302,9 +437,9 @@ namespace Synet
 
         bool GetMetaConst(const String & name, Tensor & value) const
         {
-            for (size_t i = 0; i < _param().layers().size(); ++i)
+            for (size_t i = 0; i < Param().layers().size(); ++i)
             {
-                const LayerParam & layer = _param().layers()[i];
+                const LayerParam & layer = Param().layers()[i];
                 if (layer.name() == name && layer.type() == LayerTypeMeta && layer.meta().type() == MetaTypeConst)
                 {
                     value.Import(layer.meta().alpha());
@@ -331,8 +466,24 @@ namespace Synet
             SYNET_PERF_FUNC();
             bool ftz = GetFlushToZero();
             SetFlushToZero(true);
-            for (size_t i = 0; i < _stages.size(); ++i)
-                _stages[i].layer->Forward(_stages[i].src, _stages[i].buf, _stages[i].dst);
+            if (ThreadNumber() > 1)
+                ForwardParallel();
+            else
+            {
+                for (size_t i = 0, t = 0; i < _stages.size();)
+                {
+                    if (t < _tiles.size() && _tiles[t].begin == i)
+                    {
+                        ForwardTile(_tiles[t]);
+                        i = _tiles[t++].end;
+                    }
+                    else
+                    {
+                        _stages[i].layer->Forward(_stages[i].src, _stages[i].buf, _stages[i].dst);
+                        i++;
+                    }
+                }
+            }
             SetFlushToZero(ftz);
         }
 
@@ -431,20 +582,113 @@ namespace Synet
             TensorPtrs src;
             TensorPtrs buf;
             TensorPtrs dst;
+            Index next, valued, signature;
+            size_t count;
+            bool alias;
         };
         typedef std::vector<Stage> Stages;
 
-        bool _empty;
-        NetworkParamHolder _param;
+        struct Tile
+        {
+            size_t begin, end, height;
+        };
+        typedef std::vector<Tile> Tiles;
+
+        typedef std::shared_ptr<ThreadPool> ThreadPoolPtr;
+
+        struct Plan
+        {
+            String key;
+            size_t memory;
+            LayerSharedPtrs layers;
+            TensorSharedPtrs tensors, arenas, threadBuffers;
+            TensorPtrs planned, src, dst;
+            std::vector<TensorPtrs> buffers;
+            Shape bufferSize;
+            Stages input, stages;
+            Tiles tiles;
+            LayerPtrs back;
+        };
+        typedef std::list<Plan> Plans;
+
+        static String Target()
+        {
+            String target = "cpu";
+#if defined(SYNET_GEMM_AVX512)
+            target += " avx512";
+#elif defined(SYNET_GEMM_AVX)
+            target += " avx";
+#elif defined(SYNET_GEMM_SSE)
+            target += " sse";
+#endif
+#if defined(__FMA__)
+            target += " fma";
+#endif
+#if defined(SYNET_SIMD_LIBRARY_ENABLE)
+            target += " simd";
+#endif
+#if defined(SYNET_OPEN_BLAS_ENABLE)
+            target += " openblas";
+#endif
+            return target;
+        }
+
+        size_t LayerIndex(const Layer * layer) const
+        {
+            return &layer->Param() - Param().layers().data();
+        }
+
+        bool _empty, _memoryPlan, _zeroCopy, _weightMapping;
+        size_t _tileCache, _planCache;
+        String _planKey;
+        Plans _plans;
+        ModelPtr _model;
         LayerSharedPtrs _layers;
-        TensorSharedPtrs _tensors;
+        TensorSharedPtrs _tensors, _arenas, _threadBuffers;
+        TensorPtrs _planned;
+        ThreadPoolPtr _pool;
+        std::vector<TensorPtrs> _buffers;
+        Shape _bufferSize;
 
         Stages _input, _stages;
+        Tiles _tiles;
         TensorPtrs _src, _dst;
         LayerPtrs _back;
 
+        void CreateLayers()
+        {
+            _layers.clear();
+            for (size_t i = 0; i < Param().layers().size(); ++i)
+            {
+                LayerSharedPtr layer(Create(Param().layers()[i]));
+                if (layer)
+                {
+                    layer->Share(_model->Weight(i));
+                    layer->SetCache(_model->Cache(i));
+                    if (Param().target() == Target())
+                        layer->SetState(_model->State(i));
+                    _layers.push_back(layer);
+                }
+            }
+        }
+
         bool Init()
         {
+            Build();
+            if (!Dynamic())
+                Reshape();
+            _empty = false;
+            return true;
+        }
+
+        void Build()
+        {
+            _planKey.clear();
+            _arenas.clear();
+            _planned.clear();
+            _threadBuffers.clear();
+            _buffers.clear();
+            _bufferSize.assign(BUFFER_COUNT, 0);
             _tensors.clear();
             _input.clear();
             _stages.clear();
@@ -460,12 +704,14 @@ namespace Synet
                 buf.push_back(tensor.get());
             }
 
-            NameIndexMap tensorIndex, layerIndex;
-            NameSet available;
+            NameIndexMap tensorIndex, layerIndex, constIndex;
+            NameSet available, valued;
             for (size_t i = 0; i < _layers.size(); ++i)
             {
                 Stage stage;
                 stage.layer = _layers[i].get();
+                stage.count = 0;
+                stage.alias = false;
                 const LayerParam & param = stage.layer->Param();
                 layerIndex[param.name()] = i;
                 for (size_t j = 0; j < param.src().size(); ++j)
@@ -473,6 +719,8 @@ namespace Synet
                     const String & name = param.src()[j];
                     if (tensorIndex.find(name) != tensorIndex.end())
                     {
+                        if (valued.find(name) != valued.end())
+                            stage.valued.push_back(j);
                         stage.src.push_back(_tensors[tensorIndex[name]].get());
                         if (available.find(name) != available.end())
                             available.erase(name);
@@ -486,6 +734,8 @@ namespace Synet
                     if (j < param.src().size() && name == param.src()[j])
                     {
                         stage.dst.push_back(_tensors[tensorIndex[name]].get());
+                        if (constIndex.find(name) != constIndex.end())
+                            ((ConstLayer<T>*)_layers[constIndex[name]].get())->SetWritable(true);
                     }
                     else  if (tensorIndex.find(name) != tensorIndex.end())
                     {
@@ -500,6 +750,10 @@ namespace Synet
                         stage.dst.push_back(tensor.get());
                     }
                     available.insert(name);
+                    if (param.type() == LayerTypeConst)
+                        constIndex[name] = i;
+                    if (param.type() == LayerTypeMeta)
+                        valued.insert(name);
                     if (param.type() == LayerTypeInput || (param.type() == LayerTypeMeta && (param.meta().type() == MetaTypeInput || param.meta().type() == MetaTypeInputWithDefault)))
                     {
                         _src.push_back(_tensors.back().get());
@@ -526,19 +780,802 @@ namespace Synet
                     }
                 }
             }
-            if (!Dynamic())
-                Reshape();
-            _empty = false;
+        }
+
+        String PlanKey(const Strings & srcNames, const Shapes & srcShapes, const Strings & dstNames) const
+        {
+            std::stringstream key;
+            for (size_t i = 0; i < srcNames.size(); ++i)
+                key << srcNames[i] << "=" << ValueToString(srcShapes[i]) << ";";
+            key << "|" << ValueToString(TensorIndex(_src)) << "|";
+            for (size_t i = 0; i < dstNames.size(); ++i)
+                key << dstNames[i] << ";";
+            if (dstNames.empty())
+                key << ValueToString(TensorIndex(_dst));
+            return key.str();
+        }
+
+        bool SwitchPlan(const String & key)
+        {
+            if (_planCache == 0 || _planKey.empty())
+                return false;
+            if (key == _planKey)
+                return true;
+            size_t memory = MemoryUsage();
+            for (typename Plans::iterator it = _plans.begin(); it != _plans.end(); ++it)
+            {
+                if (it->key == key)
+                {
+                    Swap(*it);
+                    it->memory = memory;
+                    _plans.splice(_plans.begin(), _plans, it);
+                    return true;
+                }
+            }
+            Index src = TensorIndex(_src), dst = TensorIndex(_dst);
+            _plans.push_front(Plan());
+            Swap(_plans.front());
+            _plans.front().memory = memory;
+            CreateLayers();
+            Build();
+            _src.clear();
+            for (size_t i = 0; i < src.size(); ++i)
+                _src.push_back(_tensors[src[i]].get());
+            _dst.clear();
+            for (size_t i = 0; i < dst.size(); ++i)
+                _dst.push_back(_tensors[dst[i]].get());
+            return false;
+        }
+
+        void Swap(Plan & plan)
+        {
+            plan.key.swap(_planKey);
+            plan.layers.swap(_layers);
+            plan.tensors.swap(_tensors);
+            plan.arenas.swap(_arenas);
+            plan.threadBuffers.swap(_threadBuffers);
+            plan.planned.swap(_planned);
+            plan.src.swap(_src);
+            plan.dst.swap(_dst);
+            plan.buffers.swap(_buffers);
+            plan.bufferSize.swap(_bufferSize);
+            plan.input.swap(_input);
+            plan.stages.swap(_stages);
+            plan.tiles.swap(_tiles);
+            plan.back.swap(_back);
+        }
+
+        Index TensorIndex(const TensorPtrs & tensors) const
+        {
+            Index index;
+            for (size_t i = 0; i < tensors.size(); ++i)
+                for (size_t j = 0; j < _tensors.size(); ++j)
+                    if (_tensors[j].get() == tensors[i])
+                        index.push_back(j);
+            return index;
+        }
+
+        size_t MemoryUsage() const
+        {
+            std::set<Tensor*> planned(_planned.begin(), _planned.end());
+            size_t size = 0;
+            for (size_t i = 0; i < _tensors.size(); ++i)
+                if (planned.find(_tensors[i].get()) == planned.end())
+                    size += _tensors[i]->Size();
+            for (size_t i = 0; i < _arenas.size(); ++i)
+                size += _arenas[i]->Size();
+            for (size_t i = 0; i < _threadBuffers.size(); ++i)
+                size += _threadBuffers[i]->Size();
+            size *= sizeof(Type);
+            for (size_t i = 0; i < _layers.size(); ++i)
+                size += _layers[i]->MemoryUsage();
+            return size;
+        }
+
+        void TrimPlans()
+        {
+            size_t memory = 0;
+            for (typename Plans::iterator it = _plans.begin(); it != _plans.end();)
+            {
+                memory += it->memory;
+                if (memory > _planCache)
+                    it = _plans.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        void ReshapeStages()
+        {
+            std::set<Tensor*> recreated;
+            for (size_t i = 0; i < _stages.size(); ++i)
+            {
+                Stage & stage = _stages[i];
+                Index signature = Signature(stage);
+                bool changed = signature != stage.signature;
+                for (size_t j = 0; j < stage.src.size() && stage.alias && !changed; ++j)
+                    changed = recreated.find(stage.src[j]) != recreated.end();
+                if (!changed)
+                    continue;
+                for (size_t j = 0; j < stage.dst.size(); ++j)
+                {
+                    if (std::find(stage.src.begin(), stage.src.end(), stage.dst[j]) != stage.src.end())
+                        continue;
+                    stage.dst[j]->Unbind();
+                    stage.dst[j]->Clear();
+                    recreated.insert(stage.dst[j]);
+                }
+                stage.layer->Reshape(stage.src, stage.buf, stage.dst);
+                stage.signature.swap(signature);
+                stage.alias = false;
+                for (size_t j = 0; j < stage.dst.size(); ++j)
+                    for (size_t k = 0; k < stage.src.size(); ++k)
+                        if (stage.dst[j] != stage.src[k] && stage.dst[j]->Shared(*stage.src[k]))
+                            stage.alias = true;
+                for (size_t j = 0; j < BUFFER_COUNT; ++j)
+                    _bufferSize[j] = std::max(_bufferSize[j], _tensors[j]->Size());
+            }
+            for (size_t j = 0; j < BUFFER_COUNT; ++j)
+                _tensors[j]->Extend(Shape({ _bufferSize[j] }));
+            GlobalConvolutionTuner().Flush();
+        }
+
+        static Index Signature(const Stage & stage)
+        {
+            Index signature(1, stage.src.size());
+            for (size_t i = 0, v = 0; i < stage.src.size(); ++i)
+            {
+                const Tensor & src = *stage.src[i];
+                signature.push_back(src.GetType());
+                signature.push_back(src.Format());
+                signature.push_back(src.Count());
+                signature.insert(signature.end(), src.Shape().begin(), src.Shape().end());
+                if (v < stage.valued.size() && stage.valued[v] == i)
+                {
+                    if (src.GetType() == TensorType32i)
+                        signature.insert(signature.end(), src.As32i().CpuData(), src.As32i().CpuData() + src.Size());
+                    else if (src.GetType() == TensorType32f)
+                    {
+                        for (size_t j = 0; j < src.Size(); ++j)
+                        {
+                            uint32_t bits;
+                            ::memcpy(&bits, src.As32f().CpuData() + j, sizeof(bits));
+                            signature.push_back(bits);
+                        }
+                    }
+                    v++;
+                }
+            }
+            return signature;
+        }
+
+        void Schedule()
+        {
+            _threadBuffers.clear();
+            _buffers.clear();
+            if (ThreadNumber() < 2)
+                return;
+
+            TensorPtrs storages;
+            std::map<Tensor*, size_t> group;
+            for (size_t i = BUFFER_COUNT; i < _tensors.size(); ++i)
+            {
+                Tensor * tensor = _tensors[i].get();
+                size_t g = 0;
+                while (g < storages.size() && !storages[g]->Shared(*tensor))
+                    g++;
+                if (g == storages.size())
+                    storages.push_back(tensor);
+                group[tensor] = g;
+            }
+
+            const size_t NONE = size_t(-1);
+            std::vector<size_t> writer(storages.size(), NONE);
+            std::vector<Index> readers(storages.size());
+            for (size_t i = 0; i < _stages.size(); ++i)
+            {
+                Stage & stage = _stages[i];
+                std::set<size_t> depends;
+                for (size_t j = 0; j < stage.src.size(); ++j)
+                {
+                    size_t g = group[stage.src[j]];
+                    if (writer[g] != NONE)
+                        depends.insert(writer[g]);
+                }
+                for (size_t j = 0; j < stage.dst.size(); ++j)
+                {
+                    size_t g = group[stage.dst[j]];
+                    if (writer[g] != NONE)
+                        depends.insert(writer[g]);
+                    depends.insert(readers[g].begin(), readers[g].end());
+                }
+                depends.erase(i);
+                for (size_t j = 0; j < stage.src.size(); ++j)
+                    readers[group[stage.src[j]]].push_back(i);
+                for (size_t j = 0; j < stage.dst.size(); ++j)
+                {
+                    size_t g = group[stage.dst[j]];
+                    writer[g] = i;
+                    readers[g].clear();
+                }
+                stage.next.clear();
+                stage.count = depends.size();
+                for (std::set<size_t>::const_iterator it = depends.begin(); it != depends.end(); ++it)
+                    _stages[*it].next.push_back(i);
+            }
+
+            _buffers.resize(ThreadNumber());
+            for (size_t j = 0; j < BUFFER_COUNT; ++j)
+                _buffers[0].push_back(_tensors[j].get());
+            for (size_t t = 1; t < _buffers.size(); ++t)
+            {
+                for (size_t j = 0; j < BUFFER_COUNT; ++j)
+                {
+                    TensorSharedPtr tensor(new Tensor({ _bufferSize[j] }));
+                    _threadBuffers.push_back(tensor);
+                    _buffers[t].push_back(tensor.get());
+                }
+            }
+        }
+
+        void ForwardParallel()
+        {
+            std::mutex mutex;
+            std::condition_variable ready;
+            Index count(_stages.size()), queue;
+            for (size_t i = _stages.size() - 1; i < _stages.size(); --i)
+            {
+                count[i] = _stages[i].count;
+                if (count[i] == 0)
+                    queue.push_back(i);
+            }
+            size_t done = 0;
+            _pool->Run([&](size_t thread)
+            {
+                bool ftz = GetFlushToZero();
+                SetFlushToZero(true);
+                std::unique_lock<std::mutex> lock(mutex);
+                for (;;)
+                {
+                    ready.wait(lock, [&] { return queue.size() || done == _stages.size(); });
+                    if (queue.empty())
+                        break;
+                    Stage & stage = _stages[queue.back()];
+                    queue.pop_back();
+                    lock.unlock();
+                    stage.layer->Forward(stage.src, _buffers[thread], stage.dst);
+                    lock.lock();
+                    done++;
+                    for (size_t j = 0; j < stage.next.size(); ++j)
+                        if (--count[stage.next[j]] == 0)
+                            queue.push_back(stage.next[j]);
+                    ready.notify_all();
+                }
+                SetFlushToZero(ftz);
+            });
+        }
+
+        void ForwardTile(const Tile & tile)
+        {
+            size_t count = tile.end - tile.begin;
+            Index done(count, 0), need(count), height(count);
+            for (size_t k = 0; k < count; ++k)
+                height[k] = _stages[tile.begin + k].dst[0]->Axis(1);
+            for (size_t y = 0; y < height[count - 1]; y += tile.height)
+            {
+                need[count - 1] = std::min(y + tile.height, height[count - 1]);
+                for (size_t k = count - 1; k > 0; --k)
+                {
+                    size_t kernel, stride, pad;
+                    _stages[tile.begin + k].layer->RowWindow(kernel, stride, pad);
+                    ptrdiff_t rows = need[k] ? ptrdiff_t((need[k] - 1) * stride + kernel) - ptrdiff_t(pad) : 0;
+                    need[k - 1] = std::min(std::max<size_t>(std::max<ptrdiff_t>(rows, 0), done[k - 1]), height[k - 1]);
+                }
+                for (size_t k = 0; k < count; ++k)
+                {
+                    if (need[k] <= done[k])
+                        continue;
+                    Stage & stage = _stages[tile.begin + k];
+                    stage.layer->ForwardRows(stage.src, stage.buf, stage.dst, done[k], need[k]);
+                    done[k] = need[k];
+                }
+            }
+            for (size_t k = 0; k < count; ++k)
+            {
+                if (done[k] < height[k])
+                {
+                    Stage & stage = _stages[tile.begin + k];
+                    stage.layer->ForwardRows(stage.src, stage.buf, stage.dst, done[k], height[k]);
+                }
+            }
+        }
+
+        struct Lifetime
+        {
+            size_t size, begin, end;
+            bool pinned;
+            TensorPtrs tensors;
+        };
+        typedef std::vector<Lifetime> Lifetimes;
+
+        struct Arena
+        {
+            size_t size;
+            std::vector<const Lifetime*> owners;
+
+            bool Free(const Lifetime & lifetime) const
+            {
+                for (size_t i = 0; i < owners.size(); ++i)
+                    if (lifetime.begin <= owners[i]->end && owners[i]->begin <= lifetime.end)
+                        return false;
+                return true;
+            }
+        };
+        typedef std::vector<Arena> Arenas;
+
+        struct View
+        {
+            Tensor * tensor;
+            Tensor * parent;
+            size_t offset;
+            Shape strides;
+        };
+        typedef std::vector<View> Views;
+        Views _views;
+
+        void ReleaseMemory()
+        {
+            std::set<Tensor*> planned(_planned.begin(), _planned.end());
+            for (size_t i = 0; i < _stages.size(); ++i)
+            {
+                Stage & stage = _stages[i];
+                if (!stage.alias)
+                    continue;
+                for (size_t j = 0; j < stage.src.size(); ++j)
+                    if (planned.find(stage.src[j]) != planned.end())
+                        stage.signature.clear();
+                for (size_t j = 0; j < stage.dst.size(); ++j)
+                    if (planned.find(stage.dst[j]) != planned.end())
+                        stage.signature.clear();
+            }
+            for (size_t i = 0; i < _planned.size(); ++i)
+                _planned[i]->Unbind();
+            _planned.clear();
+            _arenas.clear();
+        }
+
+        void PlanMemory()
+        {
+            PlanViews();
+            PlanTiles();
+            PlanArenas();
+            BindViews();
+            for (size_t i = 0; i < _tensors.size(); ++i)
+                _tensors[i]->Allocate();
+        }
+
+        void PlanViews()
+        {
+            _views.clear();
+            if (!_zeroCopy)
+                return;
+
+            std::set<Tensor*> fixed(_src.begin(), _src.end());
+            for (size_t i = 0; i < _input.size(); ++i)
+                fixed.insert(_input[i].dst.begin(), _input[i].dst.end());
+            for (size_t i = BUFFER_COUNT; i < _tensors.size(); ++i)
+            {
+                for (size_t j = i + 1; j < _tensors.size(); ++j)
+                {
+                    if (_tensors[i]->Shared(*_tensors[j]))
+                    {
+                        fixed.insert(_tensors[i].get());
+                        fixed.insert(_tensors[j].get());
+                    }
+                }
+            }
+
+            std::map<Tensor*, size_t> readers, last;
+            std::map<Tensor*, Index> writers;
+            for (size_t i = 0; i < _stages.size(); ++i)
+            {
+                const Stage & stage = _stages[i];
+                for (size_t j = 0; j < stage.src.size(); ++j)
+                {
+                    if (std::find(stage.dst.begin(), stage.dst.end(), stage.src[j]) == stage.dst.end())
+                        readers[stage.src[j]]++;
+                    last[stage.src[j]] = i;
+                }
+                for (size_t j = 0; j < stage.dst.size(); ++j)
+                {
+                    last[stage.dst[j]] = i;
+                    writers[stage.dst[j]].push_back(i);
+                    if (Pinned(stage.layer->Param()))
+                        fixed.insert(stage.dst[j]);
+                }
+            }
+
+            for (size_t i = 0; i < _stages.size(); ++i)
+            {
+                const Stage & stage = _stages[i];
+                const LayerParam & param = stage.layer->Param();
+                if (param.type() == LayerTypeConcat && stage.src.size() > 1 && !((ConcatLayer<T>*)stage.layer)->Mixed())
+                {
+                    Tensor * dst = stage.dst[0];
+                    size_t axis = dst->Index(param.concat().axis()), inner = dst->Size(axis + 1), offset = 0;
+                    bool contiguous = ((ConcatLayer<T>*)stage.layer)->Contiguous();
+                    for (size_t j = 0; j < stage.src.size(); ++j)
+                    {
+                        Tensor * src = stage.src[j];
+                        if (src != dst && src->Size() && fixed.find(src) == fixed.end() && readers[src] == 1 && last[src] == i && Viewable(src) &&
+                            std::find(_dst.begin(), _dst.end(), src) == _dst.end() && (contiguous || StridedDst(writers[src], axis)))
+                        {
+                            View view = { src, dst, offset * inner, contiguous ? Shape() : DenseStrides(dst->Shape()) };
+                            _views.push_back(view);
+                        }
+                        offset += src->Axis(axis);
+                    }
+                }
+                if ((param.type() == LayerTypeSlice && stage.dst.size() > 1 && ((SliceLayer<T>*)stage.layer)->Contiguous()) ||
+                    (param.type() == LayerTypeUnpack && stage.dst.size() > 1 && ((UnpackLayer<T>*)stage.layer)->Contiguous()))
+                {
+                    Tensor * src = stage.src[0];
+                    if (fixed.find(src) != fixed.end() && std::find(_src.begin(), _src.end(), src) == _src.end())
+                        continue;
+                    if (writers[src].size() && writers[src].back() > i)
+                        continue;
+                    size_t offset = 0;
+                    for (size_t j = 0; j < stage.dst.size(); ++j)
+                    {
+                        Tensor * dst = stage.dst[j];
+                        if (dst != src && dst->Size() && fixed.find(dst) == fixed.end() && writers[dst].size() == 1 && Viewable(dst))
+                        {
+                            View view = { dst, src, offset, Shape() };
+                            _views.push_back(view);
+                        }
+                        offset += dst->Size();
+                    }
+                }
+            }
+
+            std::set<Tensor*> aliases;
+            for (size_t i = 0; i < _stages.size(); ++i)
+            {
+                const Stage & stage = _stages[i];
+                int index = InPlace(stage);
+                if (index < 0 || index >= (int)stage.src.size() || stage.dst.size() != 1)
+                    continue;
+                Tensor * src = stage.src[index], * dst = stage.dst[0];
+                if (src == dst || src->Size() != dst->Size() || !src->Size() || fixed.find(src) != fixed.end() || fixed.find(dst) != fixed.end())
+                    continue;
+                if (last[src] != i || writers[dst].front() != i || (!Viewable(src) && aliases.find(src) == aliases.end()) ||
+                    std::find(_dst.begin(), _dst.end(), src) != _dst.end())
+                    continue;
+                bool busy = false;
+                for (size_t j = 0; j < stage.src.size(); ++j)
+                    if (j != (size_t)index && Root(stage.src[j]) == Root(src))
+                        busy = true;
+                for (size_t j = 0; j < _views.size(); ++j)
+                {
+                    Tensor * view = _views[j].tensor;
+                    if (Root(view) == Root(src) && (last[view] > i || std::find(_dst.begin(), _dst.end(), view) != _dst.end()))
+                        busy = true;
+                }
+                if (busy)
+                    continue;
+                if (Viewable(dst))
+                {
+                    View view = { dst, src, 0, Shape() };
+                    _views.push_back(view);
+                    aliases.insert(dst);
+                }
+                else if (Viewable(src) && Contiguous(dst) && Root(dst) != src)
+                {
+                    View view = { src, dst, 0, Shape() };
+                    _views.push_back(view);
+                }
+            }
+        }
+
+        bool Viewable(const Tensor * tensor) const
+        {
+            for (size_t i = 0; i < _views.size(); ++i)
+                if (_views[i].tensor == tensor)
+                    return false;
+            return true;
+        }
+
+        bool Contiguous(const Tensor * tensor) const
+        {
+            for (size_t i = 0; i < _views.size(); ++i)
+                if (_views[i].tensor == tensor)
+                    return _views[i].strides.empty();
             return true;
         }
 
+        bool StridedDst(const Index & writers, size_t axis) const
+        {
+            if (writers.size() != 1)
+                return false;
+            const Stage & stage = _stages[writers[0]];
+            if (stage.layer->Param().type() != LayerTypeConvolution || stage.dst.size() != 1)
+                return false;
+            return ((ConvolutionLayer<T>*)stage.layer)->StridedDst(axis);
+        }
+
+        static Shape DenseStrides(const Shape & shape)
+        {
+            Shape strides(shape.size(), 1);
+            for (size_t i = shape.size() - 1; i > 0; --i)
+                strides[i - 1] = strides[i] * shape[i];
+            return strides;
+        }
+
+        Tensor * Root(Tensor * tensor) const
+        {
+            for (bool found = true; found;)
+            {
+                found = false;
+                for (size_t i = 0; i < _views.size() && !found; ++i)
+                {
+                    if (_views[i].tensor == tensor)
+                    {
+                        tensor = _views[i].parent;
+                        found = true;
+                    }
+                }
+            }
+            return tensor;
+        }
+
+        void PlanTiles()
+        {
+            _tiles.clear();
+            if (_tileCache == 0)
+                return;
+            for (size_t i = 0; i < _stages.size();)
+            {
+                size_t end = i;
+                while (end < _stages.size() && Banded(i, end) && TileSize(i, end + 1, 1) <= _tileCache)
+                    end++;
+                if (end - i > 1)
+                {
+                    size_t height = _stages[end - 1].dst[0]->Axis(1), rows = 1;
+                    while (rows < height && TileSize(i, end, rows + 1) <= _tileCache)
+                        rows++;
+                    if (rows < height)
+                    {
+                        Tile tile = { i, end, rows };
+                        _tiles.push_back(tile);
+                    }
+                }
+                i = std::max(end, i + 1);
+            }
+        }
+
+        bool Banded(size_t begin, size_t index) const
+        {
+            const Stage & stage = _stages[index];
+            size_t kernel, stride, pad;
+            if (!stage.layer->RowWindow(kernel, stride, pad) || stage.src.empty() || stage.dst.size() != 1)
+                return false;
+            Tensor * src = stage.src[0], * dst = stage.dst[0];
+            if (src->Format() != TensorFormatNhwc || src->Count() != 4 || src->Axis(0) != 1 || !Contiguous(src) ||
+                dst->Format() != TensorFormatNhwc || dst->Count() != 4 || dst->Axis(0) != 1 || !Contiguous(dst))
+                return false;
+            if (index > begin && src != _stages[index - 1].dst[0])
+                return false;
+            for (size_t i = begin; i < index; ++i)
+            {
+                const Stage & prev = _stages[i];
+                for (size_t j = 1; j < stage.src.size(); ++j)
+                    if (Root(stage.src[j]) == Root(prev.dst[0]))
+                        return false;
+                for (size_t j = 1; j < prev.src.size(); ++j)
+                    if (Root(prev.src[j]) == Root(dst))
+                        return false;
+            }
+            return true;
+        }
+
+        size_t TileSize(size_t begin, size_t end, size_t rows) const
+        {
+            size_t size = 0;
+            for (size_t i = end - 1; i >= begin && i < end; --i)
+            {
+                const Stage & stage = _stages[i];
+                size_t kernel, stride, pad;
+                stage.layer->RowWindow(kernel, stride, pad);
+                rows = std::min(rows, stage.dst[0]->Axis(1));
+                size += rows * stage.dst[0]->Size(2);
+                rows = (rows - 1) * stride + kernel;
+            }
+            size += std::min(rows, _stages[begin].src[0]->Axis(1)) * _stages[begin].src[0]->Size(2);
+            return size * sizeof(Type);
+        }
+
+        void BindViews()
+        {
+            std::set<Tensor*> pending;
+            for (size_t i = 0; i < _views.size(); ++i)
+                pending.insert(_views[i].tensor);
+            for (size_t bound = 1; bound;)
+            {
+                bound = 0;
+                for (size_t i = 0; i < _views.size(); ++i)
+                {
+                    const View & view = _views[i];
+                    if (pending.find(view.tensor) == pending.end() || pending.find(view.parent) != pending.end())
+                        continue;
+                    view.tensor->View(*view.parent, view.offset, view.strides);
+                    _planned.push_back(view.tensor);
+                    pending.erase(view.tensor);
+                    bound++;
+                }
+            }
+        }
+
+        void PlanArenas()
+        {
+            if (!_memoryPlan)
+                return;
+
+            std::set<Tensor*> viewed;
+            for (size_t i = 0; i < _views.size(); ++i)
+                viewed.insert(_views[i].tensor);
+
+            Lifetimes lifetimes;
+            std::map<Tensor*, size_t> index;
+            for (size_t i = BUFFER_COUNT; i < _tensors.size(); ++i)
+            {
+                Tensor * tensor = _tensors[i].get();
+                if (viewed.find(tensor) != viewed.end())
+                    continue;
+                size_t l = 0;
+                while (l < lifetimes.size() && !lifetimes[l].tensors[0]->Shared(*tensor))
+                    l++;
+                if (l == lifetimes.size())
+                {
+                    Lifetime lifetime;
+                    lifetime.size = 0;
+                    lifetime.begin = _stages.size();
+                    lifetime.end = 0;
+                    lifetime.pinned = false;
+                    lifetimes.push_back(lifetime);
+                }
+                lifetimes[l].size = std::max(lifetimes[l].size, tensor->Size());
+                lifetimes[l].tensors.push_back(tensor);
+                index[tensor] = l;
+            }
+            for (size_t i = 0; i < _views.size(); ++i)
+                index[_views[i].tensor] = index[Root(_views[i].parent)];
+
+            for (size_t i = 0; i < _input.size(); ++i)
+                for (size_t j = 0; j < _input[i].dst.size(); ++j)
+                    lifetimes[index[_input[i].dst[j]]].pinned = true;
+            for (size_t i = 0; i < _src.size(); ++i)
+                lifetimes[index[_src[i]]].pinned = true;
+            for (size_t i = 0; i < _dst.size(); ++i)
+                lifetimes[index[_dst[i]]].end = _stages.size();
+            Index first(_stages.size()), last(_stages.size());
+            for (size_t i = 0; i < _stages.size(); ++i)
+            {
+                first[i] = i;
+                last[i] = i;
+            }
+            for (size_t t = 0; t < _tiles.size(); ++t)
+            {
+                for (size_t i = _tiles[t].begin; i < _tiles[t].end; ++i)
+                {
+                    first[i] = _tiles[t].begin;
+                    last[i] = _tiles[t].end - 1;
+                }
+            }
+            for (size_t i = 0; i < _stages.size(); ++i)
+            {
+                const Stage & stage = _stages[i];
+                for (size_t j = 0; j < stage.src.size(); ++j)
+                {
+                    Lifetime & lifetime = lifetimes[index[stage.src[j]]];
+                    lifetime.begin = std::min(lifetime.begin, first[i]);
+                    lifetime.end = std::max(lifetime.end, last[i]);
+                }
+                for (size_t j = 0; j < stage.dst.size(); ++j)
+                {
+                    Lifetime & lifetime = lifetimes[index[stage.dst[j]]];
+                    lifetime.begin = std::min(lifetime.begin, first[i]);
+                    lifetime.end = std::max(lifetime.end, last[i]);
+                    if (Pinned(stage.layer->Param()))
+                        lifetime.pinned = true;
+                }
+            }
+
+            std::vector<const Lifetime*> order;
+            for (size_t i = 0; i < lifetimes.size(); ++i)
+                if (!lifetimes[i].pinned && lifetimes[i].size && lifetimes[i].begin <= lifetimes[i].end)
+                    order.push_back(&lifetimes[i]);
+            std::stable_sort(order.begin(), order.end(), [](const Lifetime * a, const Lifetime * b) {return a->size > b->size; });
+
+            Arenas arenas;
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                const Lifetime & lifetime = *order[i];
+                size_t best = arenas.size();
+                for (size_t a = 0; a < arenas.size(); ++a)
+                {
+                    if (!arenas[a].Free(lifetime))
+                        continue;
+                    if (best == arenas.size())
+                        best = a;
+                    else if (arenas[a].size >= lifetime.size)
+                    {
+                        if (arenas[best].size < lifetime.size || arenas[a].size < arenas[best].size)
+                            best = a;
+                    }
+                    else if (arenas[a].size > arenas[best].size)
+                        best = a;
+                }
+                if (best == arenas.size())
+                {
+                    arenas.push_back(Arena());
+                    arenas[best].size = 0;
+                }
+                arenas[best].size = std::max(arenas[best].size, lifetime.size);
+                arenas[best].owners.push_back(&lifetime);
+            }
+
+            for (size_t a = 0; a < arenas.size(); ++a)
+            {
+                TensorSharedPtr arena(new Tensor({ arenas[a].size }));
+                for (size_t o = 0; o < arenas[a].owners.size(); ++o)
+                {
+                    const TensorPtrs & tensors = arenas[a].owners[o]->tensors;
+                    for (size_t t = 0; t < tensors.size(); ++t)
+                    {
+                        tensors[t]->Bind(*arena);
+                        _planned.push_back(tensors[t]);
+                    }
+                }
+                _arenas.push_back(arena);
+            }
+        }
+
+        static bool Pinned(const LayerParam & param)
+        {
+            return param.type() == LayerTypeInput || param.type() == LayerTypeMeta || 
+                param.type() == LayerTypeConst || param.type() == LayerTypeDetectionOutput;
+        }
+
+        static int InPlace(const Stage & stage)
+        {
+            switch (stage.layer->Param().type())
+            {
+            case LayerTypeBias:
+            case LayerTypeEltwise:
+            case LayerTypeFused:
+            case LayerTypeLog:
+            case LayerTypePointwise:
+            case LayerTypePrelu:
+            case LayerTypeRelu:
+            case LayerTypeRestrictRange:
+            case LayerTypeScale:
+            case LayerTypeSigmoid:
+            case LayerTypeUnaryOperation:
+                return 0;
+            case LayerTypeConvolution:
+                return ((ConvolutionLayer<T>*)stage.layer)->InPlaceResidual() ? 1 : -1;
+            default:
+                return -1;
+            }
+        }
+
         bool InsertDst(const String & name)
         {
-            if (_param().dst().empty())
+            if (Param().dst().empty())
                 return true;
-            for (size_t i = 0; i < _param().dst().size(); ++i)
+            for (size_t i = 0; i < Param().dst().size(); ++i)
             {
-                if (_param().dst()[i] == name)
+                if (Param().dst()[i] == name)
                     return true;
             }
             return false;
@@ -546,9 +1583,9 @@ namespace Synet
 
         bool Dynamic()
         {
-            for (size_t i = 0; i < _param().layers().size(); ++i)
+            for (size_t i = 0; i < Param().layers().size(); ++i)
             {
-                const LayerParam & layer = _param().layers()[i];
+                const LayerParam & layer = Param().layers()[i];
                 if (layer.type() == LayerTypeMeta && layer.meta().type() == MetaTypeInput)
                     return true;
                 if (layer.type() == LayerTypeInput)
@@ -592,12 +1629,14 @@ namespace Synet
             case LayerTypeNormalize: return new NormalizeLayer<T>(param);
             case LayerTypePad: return new PadLayer<T>(param);
             case LayerTypePermute: return new PermuteLayer<T>(param);
+            case LayerTypePointwise: return new PointwiseLayer<T>(param);
             case LayerTypePooling: return new PoolingLayer<T>(param);
             case LayerTypePrelu: return new PreluLayer<T>(param);
             case LayerTypePriorBox: return new PriorBoxLayer<T>(param);
             case LayerTypeReduction: return new ReductionLayer<T>(param);
             case LayerTypeRegion: return new RegionLayer<T>(param);
             case LayerTypeRelu: return new ReluLayer<T>(param);
+            case LayerTypeReorder: return new ReorderLayer<T>(param);
             case LayerTypeReorg: return new ReorgLayer<T>(param);
             case LayerTypeReshape: return new ReshapeLayer<T>(param);
             case LayerTypeRestrictRange: return new RestrictRangeLayer<T>(param);
@@ -29,6 +29,96 @@
 
 namespace Synet
 {
+    struct BinaryParamWriter
+    {
+        std::vector<char> data;
+        Strings strings;
+
+        uint32_t Intern(const String & string)
+        {
+            std::map<String, uint32_t>::const_iterator it = _index.find(string);
+            if (it != _index.end())
+                return it->second;
+            uint32_t id = (uint32_t)strings.size();
+            strings.push_back(string);
+            _index[string] = id;
+            return id;
+        }
+
+        template<class T> SYNET_INLINE void Write(const T & value)
+        {
+            Write(&value, sizeof(T));
+        }
+
+        SYNET_INLINE void Write(const void * src, size_t size)
+        {
+            data.insert(data.end(), (const char*)src, (const char*)src + size);
+        }
+
+        SYNET_INLINE size_t Reserve()
+        {
+            Write(uint32_t(0));
+            return data.size();
+        }
+
+        SYNET_INLINE void Patch(size_t reserved)
+        {
+            uint32_t size = uint32_t(data.size() - reserved);
+            ::memcpy(data.data() + reserved - sizeof(size), &size, sizeof(size));
+        }
+
+    private:
+        std::map<String, uint32_t> _index;
+    };
+
+    struct BinaryParamReader
+    {
+        const char * data;
+        const char * end;
+        const Strings & strings;
+
+        BinaryParamReader(const char * data_, const char * end_, const Strings & strings_)
+            : data(data_)
+            , end(end_)
+            , strings(strings_)
+        {
+        }
+
+        template<class T> SYNET_INLINE bool Read(T & value)
+        {
+            return Read(&value, sizeof(T));
+        }
+
+        SYNET_INLINE bool Read(void * dst, size_t size)
+        {
+            if (size > size_t(end - data))
+                return false;
+            ::memcpy(dst, data, size);
+            data += size;
+            return true;
+        }
+
+        SYNET_INLINE bool Read(String & string)
+        {
+            uint32_t id;
+            if (!Read(id) || id >= strings.size())
+                return false;
+            string = strings[id];
+            return true;
+        }
+
+        SYNET_INLINE bool Block(BinaryParamReader & block)
+        {
+            uint32_t size;
+            if (!Read(size) || size > size_t(end - data))
+                return false;
+            block.data = data;
+            block.end = data + size;
+            data += size;
+            return true;
+        }
+    };
+
     template<class T> struct Param
     {
         typedef T Type;
@@ -111,15 +201,97 @@ namespace Synet
         bool Load(const String & path)
         {
             bool result = false;
-            std::ifstream ifs(path.c_str());
+            std::ifstream ifs(path.c_str(), std::ifstream::binary);
             if (ifs.is_open())
             {
-                result = this->Load(ifs);
+                if (Binary(ifs))
+                    result = this->LoadBinary(ifs);
+                else
+                {
+                    ifs.close();
+                    ifs.open(path.c_str());
+                    result = this->Load(ifs);
+                }
                 ifs.close();
             }
             return result;
         }
 
+        bool SaveBinary(std::ostream & os) const
+        {
+            BinaryParamWriter writer;
+            this->SaveBinaryField(writer);
+            os.write(BinaryMagic(), 8);
+            uint32_t header[2] = { BINARY_VERSION, (uint32_t)writer.strings.size() };
+            os.write((const char*)header, sizeof(header));
+            for (size_t i = 0; i < writer.strings.size(); ++i)
+            {
+                uint32_t size = (uint32_t)writer.strings[i].size();
+                os.write((const char*)&size, sizeof(size));
+                os.write(writer.strings[i].data(), size);
+            }
+            os.write(writer.data.data(), writer.data.size());
+            return (bool)os;
+        }
+
+        bool SaveBinary(const String & path) const
+        {
+            bool result = false;
+            std::ofstream ofs(path.c_str(), std::ofstream::binary);
+            if (ofs.is_open())
+            {
+                result = this->SaveBinary(ofs);
+                ofs.close();
+            }
+            return result;
+        }
+
+        bool LoadBinary(std::istream & is)
+        {
+            std::vector<char> data((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+            Strings strings;
+            BinaryParamReader reader(data.data(), data.data() + data.size(), strings);
+            char magic[8];
+            uint32_t header[2];
+            if (!reader.Read(magic, 8) || ::memcmp(magic, BinaryMagic(), 8) != 0 || !reader.Read(header) || header[0] != BINARY_VERSION)
+                return false;
+            strings.resize(header[1]);
+            for (size_t i = 0; i < strings.size(); ++i)
+            {
+                uint32_t size;
+                if (!reader.Read(size) || size > size_t(reader.end - reader.data))
+                    return false;
+                strings[i].assign(reader.data, size);
+                reader.data += size;
+            }
+            String name;
+            BinaryParamReader block(NULL, NULL, strings);
+            if (!reader.Read(name) || name != this->Name() || !reader.Block(block))
+                return false;
+            return this->LoadBinary(block);
+        }
+
+        bool LoadBinary(const String & path)
+        {
+            bool result = false;
+            std::ifstream ifs(path.c_str(), std::ifstream::binary);
+            if (ifs.is_open())
+            {
+                result = this->LoadBinary(ifs);
+                ifs.close();
+            }
+            return result;
+        }
+
+        static bool Binary(std::istream & is)
+        {
+            char magic[8];
+            bool binary = is.read(magic, 8) && ::memcmp(magic, BinaryMagic(), 8) == 0;
+            is.clear();
+            is.seekg(0);
+            return binary;
+        }
+
     protected:
         enum Mode
         {
@@ -142,10 +314,15 @@ namespace Synet
         }
         
         virtual String ToString() const { return ""; }
-        virtual void ToValue(const String & string) {}
-        virtual void Resize(size_t size) {}
+        virtual void ToValue(const String & /*string*/) {}
+        virtual void ToBinary(BinaryParamWriter & /*writer*/) const {}
+        virtual bool FromBinary(BinaryParamReader & /*reader*/) { return false; }
+        virtual void Resize(size_t /*size*/) {}
         SYNET_INLINE String ItemName() const { return "item"; }
 
+        enum { BINARY_VERSION = 1 };
+        static SYNET_INLINE const char * BinaryMagic() { return "SYNETPRM"; }
+
         template<typename> friend struct Param;
 
         typedef Param<int> Unknown;
@@ -227,6 +404,87 @@ namespace Synet
             }
             xmlParent->AppendNode(xmlCurrent);
         }
+
+        void SaveBinaryField(BinaryParamWriter & writer) const
+        {
+            writer.Write(writer.Intern(this->Name()));
+            size_t reserved = writer.Reserve();
+            switch (_mode)
+            {
+            case Value:
+                this->ToBinary(writer);
+                break;
+            case Struct:
+                for (const Unknown * paramChild = this->StructBegin(); paramChild < this->StructEnd(); paramChild = this->StructNext(paramChild))
+                {
+                    if (paramChild->Changed())
+                        paramChild->SaveBinaryField(writer);
+                }
+                break;
+            case Vector:
+                writer.Write(uint32_t(((char*)this->VectorEnd() - (char*)this->VectorBegin()) / _item));
+                for (const Unknown * paramItem = this->VectorBegin(); paramItem < this->VectorEnd(); paramItem = this->VectorNext(paramItem))
+                {
+                    size_t item = writer.Reserve();
+                    const Unknown * paramChildEnd = this->VectorNext(paramItem);
+                    for (const Unknown * paramChild = paramItem; paramChild < paramChildEnd; paramChild = this->StructNext(paramChild))
+                    {
+                        if (paramChild->Changed())
+                            paramChild->SaveBinaryField(writer);
+                    }
+                    writer.Patch(item);
+                }
+                break;
+            }
+            writer.Patch(reserved);
+        }
+
+        bool LoadBinary(BinaryParamReader & reader)
+        {
+            switch (_mode)
+            {
+            case Value:
+                return this->FromBinary(reader) && reader.data == reader.end;
+            case Struct:
+                return LoadBinaryFields(reader, this->StructBegin(), this->StructEnd());
+            case Vector:
+            {
+                uint32_t size;
+                if (!reader.Read(size))
+                    return false;
+                this->Resize(size);
+                for (Unknown * paramItem = this->VectorBegin(); paramItem < this->VectorEnd(); paramItem = this->VectorNext(paramItem))
+                {
+                    BinaryParamReader item(NULL, NULL, reader.strings);
+                    if (!reader.Block(item) || !LoadBinaryFields(item, paramItem, this->VectorNext(paramItem)))
+                        return false;
+                }
+                return true;
+            }
+            }
+            return false;
+        }
+
+        bool LoadBinaryFields(BinaryParamReader & reader, Unknown * begin, const Unknown * end)
+        {
+            while (reader.data < reader.end)
+            {
+                String name;
+                BinaryParamReader field(NULL, NULL, reader.strings);
+                if (!reader.Read(name) || !reader.Block(field))
+                    return false;
+                for (Unknown * paramChild = begin; paramChild < end; paramChild = this->StructNext(paramChild))
+                {
+                    if (paramChild->Name() == name)
+                    {
+                        if (!paramChild->LoadBinary(field))
+                            return false;
+                        break;
+                    }
+                }
+            }
+            return true;
+        }
     };
 
     template<class T> SYNET_INLINE  String ValueToString(const T & value)
@@ -277,6 +535,105 @@ namespace Synet
         }
     }
 
+    template<class T> SYNET_INLINE void ValueToBinary(BinaryParamWriter & writer, const T & value)
+    {
+        if (std::is_enum<T>::value)
+            writer.Write(writer.Intern(ValueToString(value)));
+        else
+            writer.Write(value);
+    }
+
+    template<class T> SYNET_INLINE bool BinaryToValue(BinaryParamReader & reader, T & value)
+    {
+        if (std::is_enum<T>::value)
+        {
+            String string;
+            if (!reader.Read(string))
+                return false;
+            StringToValue(string, value);
+            return true;
+        }
+        else
+            return reader.Read(value);
+    }
+
+    SYNET_INLINE void ValueToBinary(BinaryParamWriter & writer, const size_t & value)
+    {
+        writer.Write((int64_t)value);
+    }
+
+    SYNET_INLINE bool BinaryToValue(BinaryParamReader & reader, size_t & value)
+    {
+        int64_t raw;
+        if (!reader.Read(raw))
+            return false;
+        value = (size_t)raw;
+        return true;
+    }
+
+    SYNET_INLINE void ValueToBinary(BinaryParamWriter & writer, const String & value)
+    {
+        writer.Write(writer.Intern(value));
+    }
+
+    SYNET_INLINE bool BinaryToValue(BinaryParamReader & reader, String & value)
+    {
+        return reader.Read(value);
+    }
+
+    template<class T> SYNET_INLINE void ArrayToBinary(BinaryParamWriter & writer, const std::vector<T> & values)
+    {
+        writer.Write(values.data(), values.size() * sizeof(T));
+    }
+
+    template<class T> SYNET_INLINE bool BinaryToArray(BinaryParamReader & reader, std::vector<T> & values)
+    {
+        size_t size = reader.end - reader.data;
+        if (size % sizeof(T))
+            return false;
+        values.resize(size / sizeof(T));
+        return reader.Read(values.data(), size);
+    }
+
+    SYNET_INLINE void ValueToBinary(BinaryParamWriter & writer, const std::vector<float> & values)
+    {
+        ArrayToBinary(writer, values);
+    }
+
+    SYNET_INLINE bool BinaryToValue(BinaryParamReader & reader, std::vector<float> & values)
+    {
+        return BinaryToArray(reader, values);
+    }
+
+    SYNET_INLINE void ValueToBinary(BinaryParamWriter & writer, const std::vector<int32_t> & values)
+    {
+        ArrayToBinary(writer, values);
+    }
+
+    SYNET_INLINE bool BinaryToValue(BinaryParamReader & reader, std::vector<int32_t> & values)
+    {
+        return BinaryToArray(reader, values);
+    }
+
+    template<class T> SYNET_INLINE void ValueToBinary(BinaryParamWriter & writer, const std::vector<T> & values)
+    {
+        for (size_t i = 0; i < values.size(); ++i)
+            ValueToBinary(writer, values[i]);
+    }
+
+    template<class T> SYNET_INLINE bool BinaryToValue(BinaryParamReader & reader, std::vector<T> & values)
+    {
+        values.clear();
+        while (reader.data < reader.end)
+        {
+            T value;
+            if (!BinaryToValue(reader, value))
+                return false;
+            values.push_back(value);
+        }
+        return true;
+    }
+
     SYNET_INLINE String ToLowerCase(const String & src) 
     {
         String dst(src);
@@ -325,6 +682,8 @@ Param_##name() : Base(Base::Value, #name, sizeof(Param_##name)) { this->_value =
 virtual type Default() const { return value; } \
 virtual Synet::String ToString() const { using namespace Synet; return ValueToString((*this)()); } \
 virtual void ToValue(const Synet::String & string) { using namespace Synet; StringToValue(string, this->_value); } \
+virtual void ToBinary(Synet::BinaryParamWriter & writer) const { using namespace Synet; ValueToBinary(writer, this->_value); } \
+virtual bool FromBinary(Synet::BinaryParamReader & reader) { using namespace Synet; return BinaryToValue(reader, this->_value); } \
 virtual bool Changed() const { return this->Default() != this->_value; } \
 virtual void Clone(const Param_##name & other) { this->_value = other._value; } \
 } name;
@@ -54,12 +54,14 @@ namespace Synet
         LayerTypeNormalize,
         LayerTypePad,
         LayerTypePermute,
+        LayerTypePointwise,
         LayerTypePooling,
         LayerTypePrelu,
         LayerTypePriorBox,
         LayerTypeReduction,
         LayerTypeRegion,
         LayerTypeRelu,
+        LayerTypeReorder,
         LayerTypeReorg,
         LayerTypeReshape,
         LayerTypeRestrictRange,
@@ -83,6 +85,12 @@ namespace Synet
         ActivationFunctionTypeRestrictRange,
         ActivationFunctionTypePrelu);
 
+    SYNET_PARAM_ENUM(ConvolutionAlgorithmType,
+        ConvolutionAlgorithmTypeAuto,
+        ConvolutionAlgorithmTypeImgToCol,
+        ConvolutionAlgorithmTypeWinograd,
+        ConvolutionAlgorithmTypeDirect);
+
     SYNET_PARAM_ENUM(BinaryOperationType,
         BinaryOperationTypeDiv,
         BinaryOperationTypeSub);
@@ -129,6 +137,25 @@ namespace Synet
         NormRegionTypeAcrossChannels,
         NormRegionTypeWithinChannel);
     
+    SYNET_PARAM_ENUM(PointwiseOperationType,
+        PointwiseOperationTypeAbs,
+        PointwiseOperationTypeAdd,
+        PointwiseOperationTypeBias,
+        PointwiseOperationTypeDiv,
+        PointwiseOperationTypeExp,
+        PointwiseOperationTypeLog,
+        PointwiseOperationTypeMax,
+        PointwiseOperationTypeMin,
+        PointwiseOperationTypeMul,
+        PointwiseOperationTypeNeg,
+        PointwiseOperationTypePrelu,
+        PointwiseOperationTypeRelu,
+        PointwiseOperationTypeRsqrt,
+        PointwiseOperationTypeScale,
+        PointwiseOperationTypeSigmoid,
+        PointwiseOperationTypeSqrt,
+        PointwiseOperationTypeTanh);
+
     SYNET_PARAM_ENUM(PoolingMethodType,
         PoolingMethodTypeMax,
         PoolingMethodTypeAverage,
@@ -157,7 +184,9 @@ namespace Synet
 
     SYNET_PARAM_ENUM(TensorFormat,
         TensorFormatNchw,
-        TensorFormatNhwc);
+        TensorFormatNhwc,
+        TensorFormatNchw8c,
+        TensorFormatNchw16c);
 
     SYNET_PARAM_ENUM(UnaryOperationType,
         UnaryOperationTypeAbs,
@@ -234,6 +263,9 @@ namespace Synet
         SYNET_PARAM_VALUE(ActivationFunctionType, activationType, ActivationFunctionTypeIdentity);
         SYNET_PARAM_VALUE(float, activationParam0, 0.0f);
         SYNET_PARAM_VALUE(float, activationParam1, 6.0f);
+        SYNET_PARAM_VALUE(ConvolutionAlgorithmType, algorithm, ConvolutionAlgorithmTypeAuto);
+        SYNET_PARAM_VALUE(TensorFormat, format, TensorFormatUnknown);
+        SYNET_PARAM_VALUE(bool, residual, false);
     };
 
     struct DetectionOutputParam
@@ -338,6 +370,19 @@ namespace Synet
         SYNET_PARAM_VALUE(TensorFormat, format, TensorFormatUnknown);
     };
 
+    struct PointwiseOperationParam
+    {
+        SYNET_PARAM_VALUE(PointwiseOperationType, type, PointwiseOperationTypeUnknown);
+        SYNET_PARAM_VALUE(int32_t, weight, -1);
+        SYNET_PARAM_VALUE(int32_t, src, -1);
+        SYNET_PARAM_VALUE(float, value, 0.0f);
+    };
+
+    struct PointwiseParam
+    {
+        SYNET_PARAM_VECTOR(PointwiseOperationParam, operations);
+    };
+
     struct PoolingParam
     {
         SYNET_PARAM_VALUE(PoolingMethodType, method, PoolingMethodTypeUnknown);
@@ -384,6 +429,11 @@ namespace Synet
         SYNET_PARAM_VALUE(float, negativeSlope, 0.0f);
     };
 
+    struct ReorderParam
+    {
+        SYNET_PARAM_VALUE(TensorFormat, format, TensorFormatNchw);
+    };
+
     struct ReorgParam
     {
         SYNET_PARAM_VALUE(bool, reverse, true);
@@ -457,6 +507,7 @@ namespace Synet
         SYNET_PARAM_VALUE(Strings, src, Strings());
         SYNET_PARAM_VALUE(Strings, dst, Strings());
         SYNET_PARAM_VECTOR(ShapeParam, weight);
+        SYNET_PARAM_VECTOR(ShapeParam, state);
 
         SYNET_PARAM_STRUCT(BatchNormParam, batchNorm);
         SYNET_PARAM_STRUCT(BiasParam, bias);
@@ -478,11 +529,13 @@ namespace Synet
         SYNET_PARAM_STRUCT(MetaParam, meta);
         SYNET_PARAM_STRUCT(NormalizeParam, normalize);
         SYNET_PARAM_STRUCT(PermuteParam, permute);
+        SYNET_PARAM_STRUCT(PointwiseParam, pointwise);
         SYNET_PARAM_STRUCT(PoolingParam, pooling);
         SYNET_PARAM_STRUCT(PriorBoxParam, priorBox);
         SYNET_PARAM_STRUCT(ReductionParam, reduction);
         SYNET_PARAM_STRUCT(RegionParam, region);
         SYNET_PARAM_STRUCT(ReluParam, relu);
+        SYNET_PARAM_STRUCT(ReorderParam, reorder);
         SYNET_PARAM_STRUCT(ReorgParam, reorg);
         SYNET_PARAM_STRUCT(ReshapeParam, reshape);
         SYNET_PARAM_STRUCT(RestrictRangeParam, restrictRange);
@@ -501,6 +554,7 @@ namespace Synet
     {
         SYNET_PARAM_VALUE(String, name, String());
         SYNET_PARAM_VALUE(Strings, dst, Strings());
+        SYNET_PARAM_VALUE(String, target, String());
         SYNET_PARAM_VECTOR(LayerParam, layers);
     };
 
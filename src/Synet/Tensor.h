@@ -37,6 +37,20 @@ namespace Synet
         template <> SYNET_INLINE TensorType GetTensorType<int32_t>() { return TensorType32i; }
     }
 
+    SYNET_INLINE size_t TensorFormatBlock(TensorFormat format)
+    {
+        return format == TensorFormatNchw16c ? 16 : (format == TensorFormatNchw8c ? 8 : 1);
+    }
+
+    SYNET_INLINE TensorFormat NativeBlockedFormat()
+    {
+#if defined(__AVX512F__)
+        return TensorFormatNchw16c;
+#else
+        return TensorFormatNchw8c;
+#endif
+    }
+
     template<class T> class Tensor
     {
     public:
@@ -44,7 +58,8 @@ namespace Synet
 
         SYNET_INLINE Tensor()
             : _size(0)
-            , _cpuData(std::make_shared<Vector>())
+            , _offset(0)
+            , _cpuData(std::make_shared<Buffer>())
             , _type(TensorTypeUnknown)
             , _format(TensorFormatUnknown)
         {
@@ -52,7 +67,8 @@ namespace Synet
 
         SYNET_INLINE Tensor(const Synet::Shape & shape, const Type & value = Type(), const TensorFormat & format = TensorFormatUnknown, const String & name = String())
             : _shape(shape)
-            , _cpuData(std::make_shared<Vector>())
+            , _offset(0)
+            , _cpuData(std::make_shared<Buffer>())
             , _format(format)
             , _name(name)
         {
@@ -61,7 +77,8 @@ namespace Synet
 
         SYNET_INLINE Tensor(std::initializer_list<size_t> shape, const Type & value = Type(), const TensorFormat & format = TensorFormatUnknown, const String & name = String())
             : _shape(shape.begin(), shape.end())
-            , _cpuData(std::make_shared<Vector>())
+            , _offset(0)
+            , _cpuData(std::make_shared<Buffer>())
             , _format(format)
             , _name(name)
         {
@@ -216,6 +233,16 @@ namespace Synet
             return _size;
         }
 
+        SYNET_INLINE size_t Stride(ptrdiff_t axis) const
+        {
+            return _strides.empty() ? Size(Index(axis) + 1) : _strides[Index(axis)];
+        }
+
+        SYNET_INLINE bool Dense() const
+        {
+            return _strides.empty();
+        }
+
         SYNET_INLINE size_t Offset(const Synet::Index & index) const
         {
             assert(_shape.size() == index.size());
@@ -251,13 +278,13 @@ namespace Synet
         SYNET_INLINE Type * CpuData()
         {
             assert(_type == Detail::GetTensorType<Type>());
-            return _cpuData->data();
+            return _cpuData->data() + _offset;
         }
 
         SYNET_INLINE const Type * CpuData() const
         {
             assert(_type == Detail::GetTensorType<Type>());
-            return _cpuData->data();
+            return _cpuData->data() + _offset;
         }
 
         SYNET_INLINE Type * CpuData(const Synet::Index & index)
@@ -287,6 +314,8 @@ namespace Synet
             _format = tensor._format;
             _name = tensor._name;
             _size = tensor._size;
+            _offset = tensor._offset;
+            _strides = tensor._strides;
             _cpuData = tensor._cpuData;
             SetDebugPtr();
         }
@@ -297,11 +326,73 @@ namespace Synet
             _shape = shape;
             _format = format;
             _size = Size(0, _shape.size());
-            assert(_size == tensor._size);
+            assert(_size == tensor._size && tensor.Dense());
+            _offset = tensor._offset;
+            _strides.clear();
             _cpuData = tensor._cpuData;
             SetDebugPtr();
         }
 
+        SYNET_INLINE void Attach(const Synet::Shape & shape, const TensorFormat & format, const Type * data, const std::shared_ptr<void> & holder)
+        {
+            _type = Detail::GetTensorType<Type>();
+            _shape = shape;
+            _format = format;
+            _size = Size(0, _shape.size());
+            _offset = 0;
+            _strides.clear();
+            _cpuData = std::make_shared<Buffer>(data, _size, holder);
+            SetDebugPtr();
+        }
+
+        SYNET_INLINE bool Shared(const Tensor & tensor) const
+        {
+            return _cpuData == tensor._cpuData;
+        }
+
+        SYNET_INLINE void Bind(const Tensor & arena)
+        {
+            assert(arena._cpuData->size() >= _size);
+            _offset = 0;
+            _strides.clear();
+            _cpuData = arena._cpuData;
+            SetDebugPtr();
+        }
+
+        SYNET_INLINE void View(const Tensor & parent, size_t offset, const Synet::Shape & strides = Synet::Shape())
+        {
+            assert(strides.empty() || strides.size() == _shape.size());
+#ifndef NDEBUG
+            size_t extent = _size;
+            if (strides.size() && _size)
+            {
+                extent = 1;
+                for (size_t i = 0; i < _shape.size(); ++i)
+                    extent += (_shape[i] - 1) * strides[i];
+            }
+            assert(parent._offset + offset + extent <= parent._cpuData->size());
+#endif
+            _offset = parent._offset + offset;
+            _strides = strides;
+            _cpuData = parent._cpuData;
+            SetDebugPtr();
+        }
+
+        SYNET_INLINE void Unbind()
+        {
+            _offset = 0;
+            _strides.clear();
+            _cpuData = std::make_shared<Buffer>();
+            SetDebugPtr();
+        }
+
+        SYNET_INLINE void Allocate()
+        {
+            if (_offset + _size > _cpuData->size())
+                _cpuData->resize(_offset + _size);
+            SetDebugPtr();
+        }
+
         SYNET_INLINE void Clone(const Tensor & tensor)
         {
             _type = tensor._type;
@@ -309,7 +400,7 @@ namespace Synet
             _format = tensor._format;
             _name = tensor._name;
             _size = tensor._size;
-            _cpuData(std::make_shared<Vector>(tensor._cpuData->begin(), tensor._cpuData->end()));
+            _cpuData(std::make_shared<Buffer>(tensor._cpuData->begin(), tensor._cpuData->end()));
             SetDebugPtr();
         }
 
@@ -451,6 +542,12 @@ namespace Synet
         {
             _type = Detail::GetTensorType<Type>();
             _size = Size(0, _shape.size());
+            if (_offset || _strides.size())
+            {
+                _offset = 0;
+                _strides.clear();
+                _cpuData = std::make_shared<Buffer>();
+            }
             _cpuData->resize(_size, value);
             SetDebugPtr();
         }
@@ -461,8 +558,8 @@ namespace Synet
                 _type = Detail::GetTensorType<Type>();
             assert(_type == Detail::GetTensorType<Type>());
             _size = Size(0, _shape.size());
-            if (_size > _cpuData->size())
-                _cpuData->resize(_size);
+            if (_offset + _size > _cpuData->size())
+                _cpuData->resize(_offset + _size);
             SetDebugPtr();
         }
 
@@ -471,7 +568,7 @@ namespace Synet
 
         SYNET_INLINE void SetDebugPtr()
         {
-            _ptr = _cpuData->data();
+            _ptr = _cpuData->data() + _offset;
         }
 #else
         SYNET_INLINE void SetDebugPtr()
@@ -484,13 +581,97 @@ namespace Synet
 #else
         typedef std::vector<Type, std::allocator<Type>> Vector;
 #endif
-        typedef std::shared_ptr<Vector> VectorPtr;
+
+        class Buffer
+        {
+        public:
+            Buffer()
+                : _data(NULL)
+                , _size(0)
+            {
+            }
+
+            Buffer(size_t size)
+                : _vector(size)
+            {
+                Update();
+            }
+
+            template<class Iterator> Buffer(Iterator begin, Iterator end)
+                : _vector(begin, end)
+            {
+                Update();
+            }
+
+            Buffer(const Type * data, size_t size, const std::shared_ptr<void> & holder)
+                : _data((Type*)data)
+                , _size(size)
+                , _holder(holder)
+            {
+            }
+
+            SYNET_INLINE Type * data()
+            {
+                return _data;
+            }
+
+            SYNET_INLINE const Type * data() const
+            {
+                return _data;
+            }
+
+            SYNET_INLINE size_t size() const
+            {
+                return _size;
+            }
+
+            SYNET_INLINE const Type * begin() const
+            {
+                return _data;
+            }
+
+            SYNET_INLINE const Type * end() const
+            {
+                return _data + _size;
+            }
+
+            void resize(size_t size, const Type & value = Type())
+            {
+                if (_holder)
+                {
+                    _vector.assign(_data, _data + _size);
+                    _holder.reset();
+                }
+                _vector.resize(size, value);
+                Update();
+            }
+
+            void clear()
+            {
+                _holder.reset();
+                _vector.clear();
+                Update();
+            }
+
+        private:
+            SYNET_INLINE void Update()
+            {
+                _data = _vector.data();
+                _size = _vector.size();
+            }
+
+            Vector _vector;
+            Type * _data;
+            size_t _size;
+            std::shared_ptr<void> _holder;
+        };
+        typedef std::shared_ptr<Buffer> BufferPtr;
 
         Synet::String _name;
         TensorType _type;
         TensorFormat _format;
-        Synet::Shape _shape;
-        size_t _size;
-        VectorPtr _cpuData;
+        Synet::Shape _shape, _strides;
+        size_t _size, _offset;
+        BufferPtr _cpuData;
     };
 }
\ No newline at end of file
@@ -46,11 +46,15 @@ namespace Synet
         {
         }
 
-        bool Enable()
+        bool Enable() const
         {
             return _convolution != NULL;
         }
 
+        void Release()
+        {
+        }
+
         size_t BufferSize()
         {
             return 1;
@@ -75,10 +79,18 @@ namespace Synet
             ::SimdRelease(_convolution);
     }
 
+    template<> SYNET_INLINE void Convolution<float>::Release()
+    {
+        if (_convolution)
+            ::SimdRelease(_convolution);
+        _convolution = NULL;
+    }
+
     template<> SYNET_INLINE void Convolution<float>::Init(size_t srcC, size_t srcH, size_t srcW, int srcT, size_t dstC, int dstT,
         size_t kernelY, size_t kernelX, size_t dilationY, size_t dilationX, size_t strideY, size_t strideX,
         size_t padY, size_t padX, size_t padH, size_t padW, size_t group, ActivationFunctionType activation)
     {
+        Release();
         _convolution = ::SimdConvolutionInit(srcC, srcH, srcW, (::SimdBool)srcT, dstC, (::SimdBool)dstT, kernelY, kernelX,
             dilationY, dilationX, strideY, strideX, padY, padX, padH, padW, group, (::SimdConvolutionActivationType)activation);
     }
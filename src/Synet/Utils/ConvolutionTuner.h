@@ -0,0 +1,185 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Synet/Common.h"
+#include "Synet/Params.h"
+
+#include <mutex>
+#include <cstdio>
+#include <chrono>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Synet
+{
+    class ConvolutionTuner
+    {
+    public:
+        ConvolutionTuner()
+            : _enable(false)
+            , _modified(false)
+            , _cpu(CpuModel())
+        {
+        }
+
+        ~ConvolutionTuner()
+        {
+            Flush();
+        }
+
+        bool Enable() const
+        {
+            return _enable;
+        }
+
+        void Enable(bool enable, const String & cache = String())
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            Save();
+            _enable = enable;
+            _cache = cache;
+            _algorithms.clear();
+            if (_enable && _cache.size())
+                Load();
+        }
+
+        bool Find(const String & key, ConvolutionAlgorithmType & algorithm) const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            Algorithms::const_iterator it = _algorithms.find(Key(key));
+            if (it == _algorithms.end())
+                return false;
+            algorithm = it->second;
+            return true;
+        }
+
+        void Update(const String & key, ConvolutionAlgorithmType algorithm)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _algorithms[Key(key)] = algorithm;
+            _modified = true;
+        }
+
+        void Flush()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            Save();
+        }
+
+        static double Time()
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static String CpuModel()
+        {
+            String model;
+#if defined(__linux__)
+            std::ifstream ifs("/proc/cpuinfo");
+            String line;
+            while (model.empty() && std::getline(ifs, line))
+            {
+                if (line.find("model name") == 0 && line.find(':') != String::npos)
+                    model = line.substr(line.find(':') + 1);
+            }
+#elif defined(_MSC_VER)
+            int info[12];
+            __cpuid(info + 0, 0x80000002);
+            __cpuid(info + 4, 0x80000003);
+            __cpuid(info + 8, 0x80000004);
+            model.assign((char*)info, sizeof(info));
+            model = model.substr(0, model.find('\0'));
+#endif
+            std::replace(model.begin(), model.end(), '\t', ' ');
+            size_t begin = model.find_first_not_of(' '), end = model.find_last_not_of(' ');
+            return begin == String::npos ? String("Unknown") : model.substr(begin, end - begin + 1);
+        }
+
+    private:
+        typedef std::map<String, ConvolutionAlgorithmType> Algorithms;
+
+        String Key(const String & key) const
+        {
+            return _cpu + "\t" + key;
+        }
+
+        void Load()
+        {
+            std::ifstream ifs(_cache.c_str());
+            String line;
+            while (std::getline(ifs, line))
+            {
+                size_t pos = line.rfind('\t');
+                if (pos == String::npos || line.find('\t') == pos)
+                    continue;
+                ConvolutionAlgorithmType algorithm;
+                StringToValue(line.substr(pos + 1), algorithm);
+                if (algorithm != ConvolutionAlgorithmTypeUnknown)
+                    _algorithms[line.substr(0, pos)] = algorithm;
+            }
+        }
+
+        void Save()
+        {
+            if (!_modified || _cache.empty())
+                return;
+            String temp = _cache + ".tmp";
+            std::ofstream ofs(temp.c_str());
+            for (Algorithms::const_iterator it = _algorithms.begin(); it != _algorithms.end(); ++it)
+                ofs << it->first << "\t" << ValueToString(it->second) << "\n";
+            ofs.close();
+            if (!ofs)
+            {
+                std::remove(temp.c_str());
+                return;
+            }
+#ifdef _MSC_VER
+            std::remove(_cache.c_str());
+#endif
+            if (std::rename(temp.c_str(), _cache.c_str()) == 0)
+                _modified = false;
+        }
+
+        bool _enable, _modified;
+        String _cpu, _cache;
+        Algorithms _algorithms;
+        mutable std::mutex _mutex;
+    };
+
+    inline ConvolutionTuner & GlobalConvolutionTuner()
+    {
+        static ConvolutionTuner tuner;
+        return tuner;
+    }
+
+    inline void SetConvolutionTuning(bool enable, const String & cache = String())
+    {
+        GlobalConvolutionTuner().Enable(enable, cache);
+    }
+}
@@ -0,0 +1,124 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Common.h"
+
+#ifdef _MSC_VER
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace Synet
+{
+    class FileMap
+    {
+    public:
+        FileMap()
+            : _data(NULL)
+            , _size(0)
+        {
+        }
+
+        ~FileMap()
+        {
+            Close();
+        }
+
+        bool Open(const String & path)
+        {
+            Close();
+#ifdef _MSC_VER
+            HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (file == INVALID_HANDLE_VALUE)
+                return false;
+            LARGE_INTEGER size;
+            if (::GetFileSizeEx(file, &size) && size.QuadPart > 0)
+            {
+                HANDLE mapping = ::CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+                if (mapping)
+                {
+                    _data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    ::CloseHandle(mapping);
+                }
+                _size = _data ? (size_t)size.QuadPart : 0;
+            }
+            ::CloseHandle(file);
+#else
+            int file = ::open(path.c_str(), O_RDONLY);
+            if (file == -1)
+                return false;
+            struct stat info;
+            if (::fstat(file, &info) == 0 && info.st_size > 0)
+            {
+                void * data = ::mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+                if (data != MAP_FAILED)
+                {
+                    _data = data;
+                    _size = (size_t)info.st_size;
+                }
+            }
+            ::close(file);
+#endif
+            return _data != NULL;
+        }
+
+        void Close()
+        {
+            if (_data == NULL)
+                return;
+#ifdef _MSC_VER
+            ::UnmapViewOfFile(_data);
+#else
+            ::munmap(_data, _size);
+#endif
+            _data = NULL;
+            _size = 0;
+        }
+
+        const uint8_t * Data() const
+        {
+            return (const uint8_t*)_data;
+        }
+
+        size_t Size() const
+        {
+            return _size;
+        }
+
+    private:
+        FileMap(const FileMap &);
+        FileMap & operator = (const FileMap &);
+
+        void * _data;
+        size_t _size;
+    };
+}
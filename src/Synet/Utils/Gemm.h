@@ -26,62 +26,95 @@
 
 #include "Synet/Common.h"
 
+#if defined(__AVX512F__)
+#define SYNET_GEMM_AVX512
+#elif defined(__AVX__)
+#define SYNET_GEMM_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SYNET_GEMM_SSE
+#endif
+
+#if defined(SYNET_GEMM_AVX512) || defined(SYNET_GEMM_AVX) || defined(SYNET_GEMM_SSE)
+#include <immintrin.h>
+#endif
+
+#if !defined(SYNET_OPEN_BLAS_ENABLE) && !(defined(SYNET_GEMM_SIMD_LIBRARY) && defined(SYNET_SIMD_LIBRARY_ENABLE))
+#define SYNET_GEMM_PACKED
+#endif
+
 namespace Synet
 {
     namespace Detail
     {
+        SYNET_INLINE size_t GemmGrain(size_t N, size_t K)
+        {
+            return std::max<size_t>(1, 4096 / std::max<size_t>(1, N * K));
+        }
+
         template<class T> void CpuGemmNN(size_t M, size_t N, size_t K, T alpha, const T * A, size_t lda, const T * B, size_t ldb, T * C, size_t ldc)
         {
-            for (size_t i = 0; i < M; ++i)
+            ParallelFor(0, M, GemmGrain(N, K), [=](size_t begin, size_t end)
             {
-                for (size_t k = 0; k < K; ++k)
+                for (size_t i = begin; i < end; ++i)
                 {
-                    register T a = alpha * A[i*lda + k];
-                    for (size_t j = 0; j < N; ++j)
-                        C[i*ldc + j] += a * B[k*ldb + j];
+                    for (size_t k = 0; k < K; ++k)
+                    {
+                        T a = alpha * A[i*lda + k];
+                        for (size_t j = 0; j < N; ++j)
+                            C[i*ldc + j] += a * B[k*ldb + j];
+                    }
                 }
-            }
+            });
         }
 
         template<class T> void CpuGemmNT(size_t M, size_t N, size_t K, T alpha, const T * A, size_t lda, const T * B, size_t ldb, T * C, size_t ldc)
         {
-            for (size_t i = 0; i < M; ++i)
+            ParallelFor(0, M, GemmGrain(N, K), [=](size_t begin, size_t end)
             {
-                for (size_t j = 0; j < N; ++j)
+                for (size_t i = begin; i < end; ++i)
                 {
-                    register T sum = 0;
-                    for (size_t k = 0; k < K; ++k)
-                        sum += alpha * A[i*lda + k] * B[j*ldb + k];
-                    C[i*ldc + j] += sum;
+                    for (size_t j = 0; j < N; ++j)
+                    {
+                        T sum = 0;
+                        for (size_t k = 0; k < K; ++k)
+                            sum += alpha * A[i*lda + k] * B[j*ldb + k];
+                        C[i*ldc + j] += sum;
+                    }
                 }
-            }
+            });
         }
 
         template<class T> void CpuGemmTN(size_t M, size_t N, size_t K, T alpha, const T * A, size_t lda, const T * B, size_t ldb, T * C, size_t ldc)
         {
-            for (size_t i = 0; i < M; ++i)
+            ParallelFor(0, M, GemmGrain(N, K), [=](size_t begin, size_t end)
             {
-                for (size_t k = 0; k < K; ++k)
+                for (size_t i = begin; i < end; ++i)
                 {
-                    register T a = alpha * A[k*lda + i];
-                    for (size_t j = 0; j < N; ++j)
-                        C[i*ldc + j] += a * B[k*ldb + j];
+                    for (size_t k = 0; k < K; ++k)
+                    {
+                        T a = alpha * A[k*lda + i];
+                        for (size_t j = 0; j < N; ++j)
+                            C[i*ldc + j] += a * B[k*ldb + j];
+                    }
                 }
-            }
+            });
         }
 
         template<class T> void CpuGemmTT(size_t M, size_t N, size_t K, T alpha, const T * A, size_t lda, const T * B, size_t ldb, T * C, size_t ldc)
         {
-            for (size_t i = 0; i < M; ++i)
+            ParallelFor(0, M, GemmGrain(N, K), [=](size_t begin, size_t end)
             {
-                for (size_t j = 0; j < N; ++j)
+                for (size_t i = begin; i < end; ++i)
                 {
-                    register T sum = 0;
-                    for (size_t k = 0; k < K; ++k)
-                        sum += alpha * A[i + k * lda] * B[k + j * ldb];
-                    C[i*ldc + j] += sum;
+                    for (size_t j = 0; j < N; ++j)
+                    {
+                        T sum = 0;
+                        for (size_t k = 0; k < K; ++k)
+                            sum += alpha * A[i + k * lda] * B[k + j * ldb];
+                        C[i*ldc + j] += sum;
+                    }
                 }
-            }
+            });
         }
 
         template<class T> void CpuGemvN(size_t M, size_t N, T alpha, const T * A, const T * x, T * y)
@@ -106,6 +139,280 @@ namespace Synet
         }
     }
 
+    namespace Detail
+    {
+        template<class T> struct GemmMicro
+        {
+            static const size_t MR = 4, NR = 8;
+
+            static void Run(size_t K, T alpha, const T * A, const T * B, T beta, T * C, size_t ldc, size_t M, size_t N)
+            {
+                T acc[MR * NR];
+                for (size_t i = 0; i < MR * NR; ++i)
+                    acc[i] = T(0);
+                for (size_t k = 0; k < K; ++k, A += MR, B += NR)
+                    for (size_t i = 0; i < MR; ++i)
+                        for (size_t j = 0; j < NR; ++j)
+                            acc[i * NR + j] += A[i] * B[j];
+                Update(acc, alpha, beta, C, ldc, M, N);
+            }
+
+            static SYNET_INLINE void Update(const T * acc, T alpha, T beta, T * C, size_t ldc, size_t M, size_t N)
+            {
+                for (size_t i = 0; i < M; ++i, C += ldc, acc += NR)
+                {
+                    if (beta == T(0))
+                        for (size_t j = 0; j < N; ++j)
+                            C[j] = alpha * acc[j];
+                    else
+                        for (size_t j = 0; j < N; ++j)
+                            C[j] = beta * C[j] + alpha * acc[j];
+                }
+            }
+        };
+
+#if defined(SYNET_GEMM_AVX512) || defined(SYNET_GEMM_AVX) || defined(SYNET_GEMM_SSE)
+#if defined(SYNET_GEMM_AVX512)
+        struct GemmVector
+        {
+            typedef __m512 Type;
+            static const size_t F = 16, MR = 12;
+            static SYNET_INLINE Type Zero() { return _mm512_setzero_ps(); }
+            static SYNET_INLINE Type Set(float value) { return _mm512_set1_ps(value); }
+            static SYNET_INLINE Type Load(const float * p) { return _mm512_loadu_ps(p); }
+            static SYNET_INLINE void Store(float * p, Type a) { _mm512_storeu_ps(p, a); }
+            static SYNET_INLINE Type Mul(Type a, Type b) { return _mm512_mul_ps(a, b); }
+            static SYNET_INLINE Type Fmadd(Type a, Type b, Type c) { return _mm512_fmadd_ps(a, b, c); }
+        };
+#elif defined(SYNET_GEMM_AVX)
+        struct GemmVector
+        {
+            typedef __m256 Type;
+            static const size_t F = 8, MR = 6;
+            static SYNET_INLINE Type Zero() { return _mm256_setzero_ps(); }
+            static SYNET_INLINE Type Set(float value) { return _mm256_set1_ps(value); }
+            static SYNET_INLINE Type Load(const float * p) { return _mm256_loadu_ps(p); }
+            static SYNET_INLINE void Store(float * p, Type a) { _mm256_storeu_ps(p, a); }
+            static SYNET_INLINE Type Mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+#if defined(__FMA__) || defined(__AVX2__)
+            static SYNET_INLINE Type Fmadd(Type a, Type b, Type c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+            static SYNET_INLINE Type Fmadd(Type a, Type b, Type c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+        };
+#else
+        struct GemmVector
+        {
+            typedef __m128 Type;
+            static const size_t F = 4, MR = 6;
+            static SYNET_INLINE Type Zero() { return _mm_setzero_ps(); }
+            static SYNET_INLINE Type Set(float value) { return _mm_set1_ps(value); }
+            static SYNET_INLINE Type Load(const float * p) { return _mm_loadu_ps(p); }
+            static SYNET_INLINE void Store(float * p, Type a) { _mm_storeu_ps(p, a); }
+            static SYNET_INLINE Type Mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+            static SYNET_INLINE Type Fmadd(Type a, Type b, Type c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        };
+#endif
+
+        template<> struct GemmMicro<float>
+        {
+            typedef GemmVector V;
+            static const size_t F = V::F, MR = V::MR, NR = 2 * V::F;
+
+            static void Run(size_t K, float alpha, const float * A, const float * B, float beta, float * C, size_t ldc, size_t M, size_t N)
+            {
+                V::Type c0[MR], c1[MR];
+                for (size_t i = 0; i < MR; ++i)
+                {
+                    c0[i] = V::Zero();
+                    c1[i] = V::Zero();
+                }
+                for (size_t k = 0; k < K; ++k, A += MR, B += NR)
+                {
+                    V::Type b0 = V::Load(B + 0);
+                    V::Type b1 = V::Load(B + F);
+                    for (size_t i = 0; i < MR; ++i)
+                    {
+                        V::Type a = V::Set(A[i]);
+                        c0[i] = V::Fmadd(a, b0, c0[i]);
+                        c1[i] = V::Fmadd(a, b1, c1[i]);
+                    }
+                }
+                V::Type _alpha = V::Set(alpha);
+                if (M == MR && N == NR)
+                {
+                    if (beta == 0.0f)
+                    {
+                        for (size_t i = 0; i < MR; ++i, C += ldc)
+                        {
+                            V::Store(C + 0, V::Mul(c0[i], _alpha));
+                            V::Store(C + F, V::Mul(c1[i], _alpha));
+                        }
+                    }
+                    else
+                    {
+                        V::Type _beta = V::Set(beta);
+                        for (size_t i = 0; i < MR; ++i, C += ldc)
+                        {
+                            V::Store(C + 0, V::Fmadd(c0[i], _alpha, V::Mul(V::Load(C + 0), _beta)));
+                            V::Store(C + F, V::Fmadd(c1[i], _alpha, V::Mul(V::Load(C + F), _beta)));
+                        }
+                    }
+                }
+                else
+                {
+                    float acc[MR * NR];
+                    for (size_t i = 0; i < MR; ++i)
+                    {
+                        V::Store(acc + i * NR + 0, c0[i]);
+                        V::Store(acc + i * NR + F, c1[i]);
+                    }
+                    for (size_t i = 0; i < M; ++i, C += ldc)
+                    {
+                        if (beta == 0.0f)
+                            for (size_t j = 0; j < N; ++j)
+                                C[j] = alpha * acc[i * NR + j];
+                        else
+                            for (size_t j = 0; j < N; ++j)
+                                C[j] = beta * C[j] + alpha * acc[i * NR + j];
+                    }
+                }
+            }
+        };
+#endif
+
+        template<class T> void GemmPackA(const T * A, size_t lda, bool trans, size_t M, size_t K, size_t stride, T * dst)
+        {
+            const size_t MR = GemmMicro<T>::MR;
+            for (size_t i = 0; i < M; i += MR, dst += stride)
+            {
+                size_t m = std::min(MR, M - i);
+                T * pd = dst;
+                for (size_t k = 0; k < K; ++k, pd += MR)
+                {
+                    if (trans)
+                    {
+                        const T * ps = A + k * lda + i;
+                        for (size_t r = 0; r < m; ++r)
+                            pd[r] = ps[r];
+                    }
+                    else
+                    {
+                        const T * ps = A + i * lda + k;
+                        for (size_t r = 0; r < m; ++r)
+                            pd[r] = ps[r * lda];
+                    }
+                    for (size_t r = m; r < MR; ++r)
+                        pd[r] = T(0);
+                }
+            }
+        }
+
+        template<class T> void GemmPackB(const T * B, size_t ldb, bool trans, size_t K, size_t N, size_t stride, T * dst)
+        {
+            const size_t NR = GemmMicro<T>::NR;
+            for (size_t j = 0; j < N; j += NR, dst += stride)
+            {
+                size_t n = std::min(NR, N - j);
+                T * pd = dst;
+                for (size_t k = 0; k < K; ++k, pd += NR)
+                {
+                    if (trans)
+                    {
+                        const T * ps = B + j * ldb + k;
+                        for (size_t c = 0; c < n; ++c)
+                            pd[c] = ps[c * ldb];
+                    }
+                    else
+                    {
+                        const T * ps = B + k * ldb + j;
+                        for (size_t c = 0; c < n; ++c)
+                            pd[c] = ps[c];
+                    }
+                    for (size_t c = n; c < NR; ++c)
+                        pd[c] = T(0);
+                }
+            }
+        }
+
+        template<class T> T * GemmBuffer(size_t index, size_t size)
+        {
+            thread_local std::unique_ptr<T[]> buffers[2];
+            thread_local size_t sizes[2] = { 0, 0 };
+            if (sizes[index] < size)
+            {
+                buffers[index].reset(new T[size]);
+                sizes[index] = size;
+            }
+            return buffers[index].get();
+        }
+
+        template<class T> void CpuGemmPacked(size_t M, size_t N, size_t K, T alpha, const T * A, size_t lda, bool transA, const T * packedA, 
+            const T * B, size_t ldb, bool transB, const T * packedB, T beta, T * C, size_t ldc)
+        {
+            typedef GemmMicro<T> Micro;
+            const size_t MR = Micro::MR, NR = Micro::NR, KC = 256, MC = MR * 20, NC = NR * 64, NG = NR * 8;
+            T * bufferB = packedB ? NULL : GemmBuffer<T>(0, (std::min(N, NC) + NR - 1) / NR * NR * std::min(K, KC));
+            for (size_t jc = 0; jc < N; jc += NC)
+            {
+                size_t nc = std::min(NC, N - jc);
+                for (size_t pc = 0; pc < K; pc += KC)
+                {
+                    size_t kc = std::min(KC, K - pc);
+                    const T * pB;
+                    size_t strideB;
+                    if (packedB)
+                    {
+                        strideB = K * NR;
+                        pB = packedB + jc / NR * strideB + pc * NR;
+                    }
+                    else
+                    {
+                        strideB = kc * NR;
+                        pB = bufferB;
+                        T * buf = bufferB;
+                        ParallelFor(0, (nc + NR - 1) / NR, 1, [=](size_t begin, size_t end)
+                        {
+                            size_t j = begin * NR, n = std::min(end * NR, nc) - j;
+                            GemmPackB(transB ? B + (jc + j) * ldb + pc : B + pc * ldb + jc + j, ldb, transB, kc, n, strideB, buf + begin * strideB);
+                        });
+                    }
+                    T _beta = pc == 0 ? beta : T(1);
+                    size_t blocksM = (M + MC - 1) / MC, blocksN = (nc + NG - 1) / NG;
+                    ParallelFor(0, blocksM * blocksN, 1, [=](size_t begin, size_t end)
+                    {
+                        T * bufferA = packedA ? NULL : GemmBuffer<T>(1, (std::min(M, MC) + MR - 1) / MR * MR * kc);
+                        for (size_t b = begin; b < end; ++b)
+                        {
+                            size_t ic = b / blocksN * MC, mc = std::min(MC, M - ic);
+                            size_t jg = b % blocksN * NG, ng = std::min(NG, nc - jg);
+                            const T * pA;
+                            size_t strideA;
+                            if (packedA)
+                            {
+                                strideA = K * MR;
+                                pA = packedA + ic / MR * strideA + pc * MR;
+                            }
+                            else
+                            {
+                                strideA = kc * MR;
+                                pA = bufferA;
+                                GemmPackA(transA ? A + pc * lda + ic : A + ic * lda + pc, lda, transA, mc, kc, strideA, bufferA);
+                            }
+                            for (size_t jr = 0; jr < ng; jr += NR)
+                            {
+                                const T * pb = pB + (jg + jr) / NR * strideB;
+                                T * pC = C + ic * ldc + jc + jg + jr;
+                                for (size_t ir = 0; ir < mc; ir += MR)
+                                    Micro::Run(kc, alpha, pA + ir / MR * strideA, pb, _beta, pC + ir * ldc, ldc, std::min(MR, mc - ir), std::min(NR, ng - jr));
+                            }
+                        }
+                    });
+                }
+            }
+        }
+    }
+
     enum CblasTranspose
     {
         CblasNoTrans = 111, 
@@ -114,9 +421,54 @@ namespace Synet
         CblasConjNoTrans = 114,
     };
 
+    SYNET_INLINE bool CpuGemmPackable(size_t M, size_t N, size_t K)
+    {
+        return M * N * K > 32 * 32 * 32 && M > 1 && N > 1 && K > 1;
+    }
+
+    template <typename T> size_t CpuGemmPackSizeA(size_t M, size_t K)
+    {
+        const size_t MR = Detail::GemmMicro<T>::MR;
+        return (M + MR - 1) / MR * MR * K;
+    }
+
+    template <typename T> size_t CpuGemmPackSizeB(size_t K, size_t N)
+    {
+        const size_t NR = Detail::GemmMicro<T>::NR;
+        return (N + NR - 1) / NR * NR * K;
+    }
+
+    template <typename T> void CpuGemmPackA(CblasTranspose transA, size_t M, size_t K, const T * A, size_t lda, T * packedA)
+    {
+        Detail::GemmPackA(A, lda, transA == CblasTrans, M, K, K * Detail::GemmMicro<T>::MR, packedA);
+    }
+
+    template <typename T> void CpuGemmPackB(CblasTranspose transB, size_t K, size_t N, const T * B, size_t ldb, T * packedB)
+    {
+        Detail::GemmPackB(B, ldb, transB == CblasTrans, K, N, K * Detail::GemmMicro<T>::NR, packedB);
+    }
+
+    template <typename T> void CpuGemmPackedA(CblasTranspose transB, size_t M, size_t N, size_t K, T alpha, 
+        const T * packedA, const T * B, size_t ldb, T beta, T * C, size_t ldc)
+    {
+        Detail::CpuGemmPacked(M, N, K, alpha, (const T*)NULL, 0, false, packedA, B, ldb, transB == CblasTrans, (const T*)NULL, beta, C, ldc);
+    }
+
+    template <typename T> void CpuGemmPackedB(CblasTranspose transA, size_t M, size_t N, size_t K, T alpha, 
+        const T * A, size_t lda, const T * packedB, T beta, T * C, size_t ldc)
+    {
+        Detail::CpuGemmPacked(M, N, K, alpha, A, lda, transA == CblasTrans, (const T*)NULL, (const T*)NULL, 0, false, packedB, beta, C, ldc);
+    }
+
     template <typename T> void CpuGemm(CblasTranspose transA, CblasTranspose transB,
         size_t M, size_t N, size_t K, T alpha, const T * A, size_t lda, const T * B, size_t ldb, T beta, T * C, size_t ldc)
     {
+        if (CpuGemmPackable(M, N, K))
+        {
+            Detail::CpuGemmPacked(M, N, K, alpha, A, lda, transA == CblasTrans, (const T*)NULL, B, ldb, transB == CblasTrans, (const T*)NULL, beta, C, ldc);
+            return;
+        }
+
         for (size_t i = 0; i < M; ++i)
             for (size_t j = 0; j < N; ++j)
                 C[i*ldc + j] *= beta;
@@ -191,6 +543,10 @@ namespace Synet
         {
             ::SimdGemm32fNN(M, N, K, &alpha, A, lda, B, ldb, &beta, C, ldc);
         }
+        else if (CpuGemmPackable(M, N, K))
+        {
+            Detail::CpuGemmPacked(M, N, K, alpha, A, lda, transA == CblasTrans, (const float*)NULL, B, ldb, transB == CblasTrans, (const float*)NULL, beta, C, ldc);
+        }
         else
         {
             for (size_t i = 0; i < M; ++i)
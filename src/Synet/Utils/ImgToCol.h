@@ -29,18 +29,18 @@
 namespace Synet
 {
     template <typename T> void ImgToCol(const T * src, size_t srcC, size_t srcH, size_t srcW, size_t kernelY, size_t kernelX,
-        size_t padY, size_t padX, size_t padH, size_t padW, size_t strideY, size_t strideX, size_t dilationY, size_t dilationX, T * dst)
+        size_t padY, size_t padX, size_t padH, size_t padW, size_t strideY, size_t strideX, size_t dilationY, size_t dilationX, 
+        size_t dstY0, size_t dstY1, T * dst)
     {
         SYNET_PERF_FUNC();
 
-        size_t dstH = (srcH + padY + padH - (dilationY * (kernelY - 1) + 1)) / strideY + 1;
         size_t dstW = (srcW + padX + padW - (dilationX * (kernelX - 1) + 1)) / strideX + 1;
         size_t srcSize = srcW * srcH;
         if (dilationX == 1 && dilationY == 1 && strideX == 2 && strideY == 2 && padX == 0 && padY == 0 && padW == 0 && padH == 0 && kernelX == 1 && kernelY == 1)
         {
             for (size_t channel = 0; channel < srcC; ++channel)
             {
-                for (size_t dy = 0; dy < dstH; ++dy)
+                for (size_t dy = dstY0; dy < dstY1; ++dy)
                 {
                     const T * psrc = src + 2*dy*srcW;
                     for (size_t dx = 0, sx = 0; dx < dstW; ++dx, sx += 2)
@@ -57,8 +57,8 @@ namespace Synet
                 {
                     for (size_t kx = 0; kx < kernelX; kx++)
                     {
-                        size_t sy = ky * dilationY - padY;
-                        for (size_t dy = 0; dy < dstH; ++dy)
+                        size_t sy = dstY0 * strideY + ky * dilationY - padY;
+                        for (size_t dy = dstY0; dy < dstY1; ++dy)
                         {
                             if (sy < srcH)
                             {
@@ -93,8 +93,8 @@ namespace Synet
                 {
                     for (size_t kx = 0; kx < kernelX; ++kx)
                     {
-                        size_t sy = ky - padY;
-                        for (size_t dy = 0; dy < dstH; ++dy, ++sy)
+                        size_t sy = dstY0 + ky - padY;
+                        for (size_t dy = dstY0; dy < dstY1; ++dy, ++sy)
                         {
                             if (sy < srcH)
                             {
@@ -135,18 +135,25 @@ namespace Synet
         }
     }
 
+    template <typename T> void ImgToCol(const T * src, size_t srcC, size_t srcH, size_t srcW, size_t kernelY, size_t kernelX,
+        size_t padY, size_t padX, size_t padH, size_t padW, size_t strideY, size_t strideX, size_t dilationY, size_t dilationX, T * dst)
+    {
+        size_t dstH = (srcH + padY + padH - (dilationY * (kernelY - 1) + 1)) / strideY + 1;
+        ImgToCol(src, srcC, srcH, srcW, kernelY, kernelX, padY, padX, padH, padW, strideY, strideX, dilationY, dilationX, 0, dstH, dst);
+    }
+
     template <typename T> void ImgToRow(const T * src, size_t srcH, size_t srcW, size_t srcC, size_t kernelY, size_t kernelX,
-        size_t padY, size_t padX, size_t padH, size_t padW, size_t strideY, size_t strideX, size_t dilationY, size_t dilationX, size_t group, T * dst)
+        size_t padY, size_t padX, size_t padW, size_t strideY, size_t strideX, size_t dilationY, size_t dilationX, size_t group, 
+        size_t dstY0, size_t dstY1, T * dst)
     {
         SYNET_PERF_FUNC();
 
-        size_t dstH = (srcH + padY + padH - (dilationY * (kernelY - 1) + 1)) / strideY + 1;
         size_t dstW = (srcW + padX + padW - (dilationX * (kernelX - 1) + 1)) / strideX + 1;
 
         size_t size = srcC / group;
         for (size_t g = 0; g < group; ++g)
         {
-            for (size_t dy = 0; dy < dstH; ++dy)
+            for (size_t dy = dstY0; dy < dstY1; ++dy)
             {
                 for (size_t dx = 0; dx < dstW; ++dx)
                 {
@@ -181,4 +188,11 @@ namespace Synet
             src += size;
         }
     }
+
+    template <typename T> void ImgToRow(const T * src, size_t srcH, size_t srcW, size_t srcC, size_t kernelY, size_t kernelX,
+        size_t padY, size_t padX, size_t padH, size_t padW, size_t strideY, size_t strideX, size_t dilationY, size_t dilationX, size_t group, T * dst)
+    {
+        size_t dstH = (srcH + padY + padH - (dilationY * (kernelY - 1) + 1)) / strideY + 1;
+        ImgToRow(src, srcH, srcW, srcC, kernelY, kernelX, padY, padX, padW, strideY, strideX, dilationY, dilationX, group, 0, dstH, dst);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,205 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+
+namespace Synet
+{
+    class ThreadPool
+    {
+    public:
+        typedef std::function<void(size_t thread)> Function;
+        typedef std::function<void(size_t begin, size_t end)> Body;
+
+        ThreadPool(size_t size = 1)
+            : _stop(false)
+            , _job(0)
+            , _active(0)
+            , _function(NULL)
+        {
+            Resize(size);
+        }
+
+        ~ThreadPool()
+        {
+            Resize(1);
+        }
+
+        size_t Size() const
+        {
+            return _threads.size() + 1;
+        }
+
+        void Resize(size_t size)
+        {
+            std::lock_guard<std::mutex> run(_run);
+            size = std::max<size_t>(size, 1);
+            if (size == Size())
+                return;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _start.notify_all();
+            for (size_t i = 0; i < _threads.size(); ++i)
+                _threads[i].join();
+            _threads.clear();
+            _stop = false;
+            for (size_t i = 1; i < size; ++i)
+                _threads.push_back(std::thread(&ThreadPool::Work, this, i, _job));
+        }
+
+        void Run(const Function & function)
+        {
+            std::lock_guard<std::mutex> run(_run);
+            Execute(function);
+        }
+
+        void ParallelFor(size_t begin, size_t end, size_t grain, const Body & body)
+        {
+            if (begin >= end)
+                return;
+            grain = std::max<size_t>(grain, 1);
+            if (Inside() || end - begin <= grain)
+            {
+                body(begin, end);
+                return;
+            }
+            std::unique_lock<std::mutex> run(_run, std::try_to_lock);
+            if (!run.owns_lock() || _threads.empty())
+            {
+                body(begin, end);
+                return;
+            }
+            size_t size = end - begin, count = std::min(Size(), (size + grain - 1) / grain);
+            std::vector<Range> ranges(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                ranges[i].begin = begin + size * i / count;
+                ranges[i].end = begin + size * (i + 1) / count;
+            }
+            Execute([&](size_t thread)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    Range & range = ranges[(thread + i) % count];
+                    for (;;)
+                    {
+                        size_t current = range.begin.fetch_add(grain);
+                        if (current >= range.end)
+                            break;
+                        body(current, std::min(current + grain, range.end));
+                    }
+                }
+            });
+        }
+
+    private:
+        struct Range
+        {
+            std::atomic<size_t> begin;
+            size_t end;
+        };
+
+        static bool & Inside()
+        {
+            thread_local bool inside = false;
+            return inside;
+        }
+
+        void Execute(const Function & function)
+        {
+            if (_threads.empty())
+            {
+                function(0);
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _function = &function;
+                _active = _threads.size();
+                _job++;
+            }
+            _start.notify_all();
+            Inside() = true;
+            function(0);
+            Inside() = false;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _finish.wait(lock, [this] { return _active == 0; });
+                _function = NULL;
+            }
+        }
+
+        void Work(size_t thread, size_t job)
+        {
+            Inside() = true;
+            for (;;)
+            {
+                const Function * function;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _start.wait(lock, [this, job] { return _stop || _job != job; });
+                    if (_stop)
+                        return;
+                    job = _job;
+                    function = _function;
+                }
+                (*function)(thread);
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (--_active == 0)
+                        _finish.notify_one();
+                }
+            }
+        }
+
+        std::vector<std::thread> _threads;
+        std::mutex _mutex, _run;
+        std::condition_variable _start, _finish;
+        bool _stop;
+        size_t _job, _active;
+        const Function * _function;
+    };
+
+    inline ThreadPool & GlobalThreadPool()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    inline void ParallelFor(size_t begin, size_t end, size_t grain, const ThreadPool::Body & body)
+    {
+        GlobalThreadPool().ParallelFor(begin, end, grain, body);
+    }
+}
@@ -0,0 +1,91 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Common.h"
+#include "Synet/Tensor.h"
+
+namespace Synet
+{
+    struct WeightFileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t alignment;
+        uint64_t reserved[6];
+    };
+
+    SYNET_INLINE const char * WeightFileMagic()
+    {
+        return "SYNETBIN";
+    }
+
+    SYNET_INLINE bool ReadWeightFileHeader(const void * data, size_t size, size_t & alignment, size_t & offset)
+    {
+        const WeightFileHeader * header = (const WeightFileHeader *)data;
+        alignment = 0;
+        offset = 0;
+        if (size < sizeof(WeightFileHeader) || ::memcmp(header->magic, WeightFileMagic(), sizeof(header->magic)) != 0)
+            return true;
+        if (header->version != 1 || header->alignment == 0 || (header->alignment & (header->alignment - 1)))
+            return false;
+        alignment = header->alignment;
+        offset = sizeof(WeightFileHeader);
+        return true;
+    }
+
+    SYNET_INLINE size_t WeightFileOffset(size_t offset, size_t alignment)
+    {
+        return alignment ? (offset + alignment - 1) / alignment * alignment : offset;
+    }
+
+    template<class T> bool SaveWeight(const std::vector<Tensor<T>> & weight, const String & path, size_t alignment = SYNET_WEIGHT_ALIGNMENT)
+    {
+        std::ofstream ofs(path.c_str(), std::ofstream::binary);
+        if (!ofs.is_open())
+            return false;
+        std::vector<char> zero(alignment, 0);
+        size_t offset = 0;
+        if (alignment)
+        {
+            WeightFileHeader header;
+            ::memset(&header, 0, sizeof(header));
+            ::memcpy(header.magic, WeightFileMagic(), sizeof(header.magic));
+            header.version = 1;
+            header.alignment = (uint32_t)alignment;
+            ofs.write((const char*)&header, sizeof(header));
+            offset += sizeof(header);
+        }
+        for (size_t i = 0; i < weight.size(); ++i)
+        {
+            size_t aligned = WeightFileOffset(offset, alignment);
+            ofs.write(zero.data(), aligned - offset);
+            ofs.write((const char*)weight[i].CpuData(), weight[i].Size() * sizeof(T));
+            offset = aligned + weight[i].Size() * sizeof(T);
+        }
+        ofs.close();
+        return (bool)ofs;
+    }
+}
@@ -847,9 +847,10 @@ namespace Synet
         void Init(Shape src, size_t dst, Shape kernel, Shape stride, Shape dilation, Shape pad, size_t group)
         {
             assert(src.size() == 3 && kernel.size() == 2 && stride.size() == 2 && dilation.size() == 2 && pad.size() == 4);
+            _type = Winograd::WinogradNone;
             if (stride[0] != 1 || stride[1] != 1 || dilation[0] != 1 || dilation[1] != 1)
                 return;
-            if (!((pad[0] == 0 && pad[1] == 0) || (pad[0] == 1 && pad[1] == 1)))
+            if (!((pad[0] == 0 && pad[1] == 0) || (pad[0] == 1 && pad[1] == 1)) || pad[2] != pad[0] || pad[3] != pad[1])
                 return;
             if (group != 1)
                 return;
@@ -867,16 +868,14 @@ namespace Synet
                 }
                 else
                 {
+                    if (_srcH < 3 || _srcW < 3)
+                        return;
                     _pad = false;
                     _dstH = _srcH - 2;
                     _dstW = _srcW - 2;
                 }
 
-                if (src[0] < 16)
-                    return;
-                else
-
-                if (1)
+                if (_dstH < 8 || _dstW < 8)
                 {
                     _block = 2;
                     _count = 16;
@@ -906,7 +905,8 @@ namespace Synet
         {
             SYNET_PERF_FUNC();
 
-            _filter.Reshape({ _count, _strideF }, 0);
+            _filter = Tensor();
+            _filter.Reshape(FilterShape(), 0);
             switch (_type)
             {
             case Winograd::Winograd2x3i:
@@ -921,6 +921,43 @@ namespace Synet
             default:
                 assert(0);
             }
+
+            _packed = Tensor();
+            Shape packed = PackedShape();
+            if (packed.size())
+            {
+                _packed.Reshape(packed);
+                for (size_t i = 0; i < _count; ++i)
+                    CpuGemmPackA(CblasNoTrans, _dstC, _srcC, _filter.CpuData() + i * _strideF, _srcC, _packed.CpuData() + i * packed[1]);
+            }
+        }
+
+        void SetFilter(const Synet::Tensor<T> & filter, const Synet::Tensor<T> & packed)
+        {
+            assert(filter.Shape() == FilterShape() && packed.Shape() == PackedShape());
+            _filter = filter;
+            _packed = packed;
+        }
+
+        Shape FilterShape() const
+        {
+            return Shape({ _count, _strideF });
+        }
+
+        Shape PackedShape() const
+        {
+#ifdef SYNET_GEMM_PACKED
+            if (CpuGemmPackable(_dstC, _tileW * _tileH, _srcC))
+                return Shape({ _count, CpuGemmPackSizeA<T>(_dstC, _srcC) });
+#endif
+            return Shape();
+        }
+
+        void Export(std::vector<Synet::Tensor<T>> & state) const
+        {
+            state.push_back(_filter);
+            if (_packed.Size())
+                state.push_back(_packed);
         }
 
         size_t SrcBufSize()
@@ -960,7 +997,7 @@ namespace Synet
         size_t _count, _block, _tileH, _tileW, _strideF, _strideS, _strideD;
         size_t _group, _wStep, _dStep;
         
-        Tensor _filter;
+        Tensor _filter, _packed;
         const T * _weight;
 
         void SetInput(const T * src, T * dst)
@@ -1001,10 +1038,12 @@ namespace Synet
 
                 for (size_t i = 0; i < _count; ++i)
                 {
-                    const T * a = _filter.CpuData() + i * _strideF;
                     const T * b = src + i * _strideS;
                     T * c = dst + i * _strideD;
-                    CpuGemm(CblasNoTrans, CblasNoTrans, M, N, K, T(1.0), a, b, T(0.0), c);
+                    if (_packed.Size())
+                        CpuGemmPackedA(CblasNoTrans, M, N, K, T(1.0), _packed.CpuData() + i * _packed.Size() / _count, b, N, T(0.0), c, N);
+                    else
+                        CpuGemm(CblasNoTrans, CblasNoTrans, M, N, K, T(1.0), _filter.CpuData() + i * _strideF, K, b, N, T(0.0), c, N);
                 }
                 break;
             }
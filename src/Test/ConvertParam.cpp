@@ -0,0 +1,51 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "Synet/Params.h"
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " src dst" << std::endl;
+        std::cout << "Converts network description between XML and binary format." << std::endl;
+        std::cout << "Format of src is detected automatically, dst is saved as XML if its name ends with '.xml'." << std::endl;
+        return 1;
+    }
+    Synet::String src = argv[1], dst = argv[2];
+    Synet::NetworkParamHolder param;
+    if (!param.Load(src))
+    {
+        std::cout << "Can't load network description from '" << src << "'!" << std::endl;
+        return 1;
+    }
+    bool xml = dst.size() >= 4 && Synet::ToLowerCase(dst.substr(dst.size() - 4)) == ".xml";
+    if (!(xml ? param.Save(dst, false) : param.SaveBinary(dst)))
+    {
+        std::cout << "Can't save network description to '" << dst << "'!" << std::endl;
+        return 1;
+    }
+    std::cout << "Network description is converted from '" << src << "' to '" << dst << "' (" << (xml ? "XML" : "binary") << ")." << std::endl;
+    return 0;
+}
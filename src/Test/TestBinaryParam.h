@@ -0,0 +1,87 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "TestUnit.h"
+
+namespace Test
+{
+    inline String XmlParam(const Synet::NetworkParamHolder & param)
+    {
+        std::stringstream ss;
+        param.Save(ss, true);
+        return ss.str();
+    }
+
+    inline bool BinaryParamTest()
+    {
+        UnitModel model(5);
+        model.Input("data", Shape({ 1, 8, 6, 6 }));
+        model.Convolution("conv", "data", 8, 8, 3).convolution().activationType() = Synet::ActivationFunctionTypeRestrictRange;
+        model.Add(Synet::LayerTypeEltwise, "sum", Strings({ "conv", "data" })).eltwise().coefficients() = Synet::Floats({ 0.5f, 2.0f });
+        Synet::LayerParam & pointwise = model.Add(Synet::LayerTypePointwise, "pointwise", Strings({ "sum" }));
+        pointwise.pointwise().operations().resize(2);
+        pointwise.pointwise().operations()[0].type() = Synet::PointwiseOperationTypeScale;
+        pointwise.pointwise().operations()[0].value() = 0.25f;
+        pointwise.pointwise().operations()[1].type() = Synet::PointwiseOperationTypeSigmoid;
+        model.Param().dst() = Strings({ "pointwise" });
+        TEST_CHECK(model.Save("binary_param"));
+
+        Synet::NetworkParamHolder original;
+        TEST_CHECK(original.Load("binary_param.xml"));
+        std::stringstream binary;
+        TEST_CHECK(original.SaveBinary(binary));
+        String data = binary.str();
+        TEST_CHECK(Synet::NetworkParamHolder::Binary(binary));
+
+        Synet::NetworkParamHolder loaded;
+        TEST_CHECK(loaded.LoadBinary(binary));
+        TEST_CHECK(XmlParam(loaded) == XmlParam(original));
+
+        TEST_CHECK(original.SaveBinary("binary_param.prm"));
+        Synet::NetworkParamHolder detected;
+        TEST_CHECK(detected.Load("binary_param.prm"));
+        TEST_CHECK(XmlParam(detected) == XmlParam(original));
+
+        const String corrupted[] = { data.substr(0, data.size() - 1), data.substr(0, 20), "SYNETXML" + data.substr(8),
+            data.substr(0, 8) + char(data[8] + 1) + data.substr(9) };
+        for (size_t i = 0; i < sizeof(corrupted) / sizeof(corrupted[0]); ++i)
+        {
+            std::stringstream ss(corrupted[i]);
+            Synet::NetworkParamHolder broken;
+            TEST_CHECK(!broken.LoadBinary(ss));
+        }
+
+        Network xml, bin;
+        TEST_CHECK(xml.Load("binary_param.xml", "binary_param.bin"));
+        TEST_CHECK(bin.Load("binary_param.prm", "binary_param.bin"));
+        Vectors control, dst;
+        Forward(xml, 1, control);
+        Forward(bin, 1, dst);
+        TEST_CHECK(Equal(control, dst, 0.0f));
+        return true;
+    }
+}
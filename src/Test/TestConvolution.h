@@ -0,0 +1,159 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "TestUnit.h"
+
+namespace Test
+{
+    struct ConvolutionParam
+    {
+        size_t srcC, srcH, srcW, dstC, kernel, stride, pad, group;
+        bool trans;
+        Synet::ConvolutionAlgorithmType algorithm;
+
+        size_t DstH() const { return (srcH + 2 * pad - kernel) / stride + 1; }
+        size_t DstW() const { return (srcW + 2 * pad - kernel) / stride + 1; }
+    };
+
+    inline void ConvolutionReference(const ConvolutionParam & p, size_t batch, const float * src, const float * weight, const float * bias, float * dst)
+    {
+        const size_t dstH = p.DstH(), dstW = p.DstW(), srcCg = p.srcC / p.group, dstCg = p.dstC / p.group;
+        for (size_t b = 0; b < batch; ++b)
+        {
+            for (size_t dc = 0; dc < p.dstC; ++dc)
+            {
+                const size_t g = dc / dstCg;
+                for (size_t dy = 0; dy < dstH; ++dy)
+                {
+                    for (size_t dx = 0; dx < dstW; ++dx)
+                    {
+                        double sum = bias[dc];
+                        for (size_t sc = 0; sc < srcCg; ++sc)
+                        {
+                            for (size_t ky = 0; ky < p.kernel; ++ky)
+                            {
+                                size_t sy = dy * p.stride + ky - p.pad;
+                                if (sy >= p.srcH)
+                                    continue;
+                                for (size_t kx = 0; kx < p.kernel; ++kx)
+                                {
+                                    size_t sx = dx * p.stride + kx - p.pad;
+                                    if (sx >= p.srcW)
+                                        continue;
+                                    size_t c = g * srcCg + sc, s, w;
+                                    if (p.trans)
+                                    {
+                                        s = ((b * p.srcH + sy) * p.srcW + sx) * p.srcC + c;
+                                        w = ((ky * p.kernel + kx) * srcCg + sc) * p.dstC + dc;
+                                    }
+                                    else
+                                    {
+                                        s = ((b * p.srcC + c) * p.srcH + sy) * p.srcW + sx;
+                                        w = ((dc * srcCg + sc) * p.kernel + ky) * p.kernel + kx;
+                                    }
+                                    sum += double(src[s]) * double(weight[w]);
+                                }
+                            }
+                        }
+                        size_t d = p.trans ? ((b * dstH + dy) * dstW + dx) * p.dstC + dc : ((b * p.dstC + dc) * dstH + dy) * dstW + dx;
+                        dst[d] = float(sum);
+                    }
+                }
+            }
+        }
+    }
+
+    inline bool ConvolutionTest(const ConvolutionParam & p, Synet::ConvolutionAlgorithmType expected)
+    {
+        const size_t batch = 2;
+        const Synet::TensorFormat format = p.trans ? Synet::TensorFormatNhwc : Synet::TensorFormatNchw;
+        Synet::LayerParam param;
+        param.type() = Synet::LayerTypeConvolution;
+        param.name() = "convolution";
+        param.convolution().outputNum() = (uint32_t)p.dstC;
+        param.convolution().kernel() = Shape({ p.kernel, p.kernel });
+        param.convolution().stride() = Shape({ p.stride, p.stride });
+        param.convolution().pad() = Shape({ p.pad, p.pad, p.pad, p.pad });
+        param.convolution().group() = (uint32_t)p.group;
+        param.convolution().algorithm() = p.algorithm;
+        Synet::ConvolutionLayer<float> layer(param);
+
+        Tensors & weight = (Tensors&)layer.Weight();
+        weight.resize(2);
+        if (p.trans)
+            weight[0].Reshape(Shape({ p.kernel, p.kernel, p.srcC / p.group, p.dstC }), 0.0f, format);
+        else
+            weight[0].Reshape(Shape({ p.dstC, p.srcC / p.group, p.kernel, p.kernel }), 0.0f, format);
+        weight[1].Reshape(Shape({ p.dstC }));
+        FillRandom(weight[0].CpuData(), weight[0].Size(), 1);
+        FillRandom(weight[1].CpuData(), weight[1].Size(), 2);
+
+        Tensor src, buf, dst;
+        src.Reshape(p.trans ? Shape({ batch, p.srcH, p.srcW, p.srcC }) : Shape({ batch, p.srcC, p.srcH, p.srcW }), 0.0f, format);
+        FillRandom(src.CpuData(), src.Size(), 3);
+        Synet::Layer<float>::TensorPtrs srcs(1, &src), bufs(1, &buf), dsts(1, &dst);
+        layer.Reshape(srcs, bufs, dsts);
+        layer.Forward(srcs, bufs, dsts);
+
+        Synet::LayerParam compiled;
+        Tensors state;
+        layer.Compile(compiled, state);
+        TEST_CHECK(compiled.convolution().algorithm() == expected);
+
+        Vector control(batch * p.dstC * p.DstH() * p.DstW());
+        ConvolutionReference(p, batch, src.CpuData(), weight[0].CpuData(), weight[1].CpuData(), control.data());
+        TEST_CHECK(dst.Size() == control.size());
+        TEST_CHECK(Equal(control.data(), dst.CpuData(), control.size(), 1e-3f));
+        return true;
+    }
+
+    inline bool ConvolutionTest()
+    {
+        const Synet::ConvolutionAlgorithmType winograd = Synet::ConvolutionAlgorithmTypeWinograd, direct = Synet::ConvolutionAlgorithmTypeDirect;
+        const ConvolutionParam winogradParams[] = {
+            { 16, 6, 7, 16, 3, 1, 1, 1, false, winograd },
+            { 24, 13, 17, 32, 3, 1, 1, 1, false, winograd },
+            { 16, 11, 12, 20, 3, 1, 0, 1, false, winograd },
+            { 32, 8, 9, 16, 3, 1, 0, 1, false, winograd },
+        };
+        for (size_t i = 0; i < sizeof(winogradParams) / sizeof(winogradParams[0]); ++i)
+            TEST_CHECK(ConvolutionTest(winogradParams[i], winograd));
+
+        const ConvolutionParam depthwiseParams[] = {
+            { 16, 12, 13, 16, 3, 1, 1, 16, false, direct },
+            { 16, 12, 13, 16, 3, 2, 1, 16, false, direct },
+            { 16, 12, 13, 16, 5, 1, 2, 16, false, direct },
+            { 17, 9, 10, 17, 5, 2, 2, 17, false, direct },
+            { 16, 12, 13, 16, 3, 1, 1, 16, true, direct },
+            { 16, 12, 13, 16, 3, 2, 1, 16, true, direct },
+            { 17, 9, 10, 17, 5, 2, 2, 17, true, direct },
+        };
+        for (size_t i = 0; i < sizeof(depthwiseParams) / sizeof(depthwiseParams[0]); ++i)
+            TEST_CHECK(ConvolutionTest(depthwiseParams[i], direct));
+        return true;
+    }
+}
@@ -0,0 +1,90 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "TestUnit.h"
+
+namespace Test
+{
+    inline void GemmReference(bool transA, bool transB, size_t M, size_t N, size_t K, float alpha, 
+        const float * A, size_t lda, const float * B, size_t ldb, float beta, float * C, size_t ldc)
+    {
+        for (size_t i = 0; i < M; ++i)
+        {
+            for (size_t j = 0; j < N; ++j)
+            {
+                double sum = 0;
+                for (size_t k = 0; k < K; ++k)
+                    sum += double(transA ? A[k * lda + i] : A[i * lda + k]) * double(transB ? B[j * ldb + k] : B[k * ldb + j]);
+                C[i * ldc + j] = float(alpha * sum + (beta == 0.0f ? 0.0 : double(beta) * C[i * ldc + j]));
+            }
+        }
+    }
+
+    inline bool GemmTest(size_t M, size_t N, size_t K, bool transA, bool transB, float alpha, float beta, unsigned seed)
+    {
+        const Synet::CblasTranspose tA = transA ? Synet::CblasTrans : Synet::CblasNoTrans;
+        const Synet::CblasTranspose tB = transB ? Synet::CblasTrans : Synet::CblasNoTrans;
+        const size_t lda = (transA ? M : K) + 3, ldb = (transB ? K : N) + 1, ldc = N + 2;
+        Vector A((transA ? K : M) * lda), B((transB ? N : K) * ldb), C(M * ldc), control(M * ldc), dst(M * ldc);
+        FillRandom(A.data(), A.size(), seed + 0);
+        FillRandom(B.data(), B.size(), seed + 1);
+        FillRandom(C.data(), C.size(), seed + 2);
+
+        control = C;
+        GemmReference(transA, transB, M, N, K, alpha, A.data(), lda, B.data(), ldb, beta, control.data(), ldc);
+
+        dst = C;
+        Synet::CpuGemm(tA, tB, M, N, K, alpha, A.data(), lda, B.data(), ldb, beta, dst.data(), ldc);
+        TEST_CHECK(Equal(control.data(), dst.data(), control.size(), 1e-4f));
+
+        Vector packedA(Synet::CpuGemmPackSizeA<float>(M, K));
+        Synet::CpuGemmPackA(tA, M, K, A.data(), lda, packedA.data());
+        dst = C;
+        Synet::CpuGemmPackedA(tB, M, N, K, alpha, packedA.data(), B.data(), ldb, beta, dst.data(), ldc);
+        TEST_CHECK(Equal(control.data(), dst.data(), control.size(), 1e-4f));
+
+        Vector packedB(Synet::CpuGemmPackSizeB<float>(K, N));
+        Synet::CpuGemmPackB(tB, K, N, B.data(), ldb, packedB.data());
+        dst = C;
+        Synet::CpuGemmPackedB(tA, M, N, K, alpha, A.data(), lda, packedB.data(), beta, dst.data(), ldc);
+        TEST_CHECK(Equal(control.data(), dst.data(), control.size(), 1e-4f));
+        return true;
+    }
+
+    inline bool GemmTest()
+    {
+        const size_t sizes[][3] = { { 1, 1, 1 }, { 7, 9, 13 }, { 13, 17, 257 }, { 64, 100, 64 }, { 130, 70, 530 } };
+        const float betas[] = { 0.0f, 0.5f, 1.0f };
+        unsigned seed = 0;
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+            for (int transA = 0; transA < 2; ++transA)
+                for (int transB = 0; transB < 2; ++transB)
+                    for (size_t b = 0; b < sizeof(betas) / sizeof(betas[0]); ++b, seed += 3)
+                        TEST_CHECK(GemmTest(sizes[s][0], sizes[s][1], sizes[s][2], transA != 0, transB != 0, 0.7f, betas[b], seed));
+        return true;
+    }
+}
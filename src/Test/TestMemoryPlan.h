@@ -0,0 +1,73 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "TestUnit.h"
+
+namespace Test
+{
+    inline bool MemoryPlanTest()
+    {
+        UnitModel model(1);
+        model.Input("data", Shape({ 1, 8, 12, 12 }));
+        model.Convolution("a", "data", 8, 8, 3);
+        model.Add(Synet::LayerTypeRelu, "b", Strings({ "a" }));
+        model.Convolution("c", "b", 8, 8, 1);
+        model.Add(Synet::LayerTypeEltwise, "d", Strings({ "b", "c" }));
+        model.Add(Synet::LayerTypeSigmoid, "e", Strings({ "d" }));
+        model.Convolution("f", "e", 8, 16, 3);
+        model.Add(Synet::LayerTypeConcat, "g", Strings({ "f", "a" }));
+        model.Add(Synet::LayerTypeRelu, "h", Strings({ "g" })).relu().negativeSlope() = 0.1f;
+        model.Add(Synet::LayerTypeSigmoid, "h", Strings({ "h" }), Strings({ "h" }));
+        TEST_CHECK(model.Save("memory_plan"));
+
+        const struct Config
+        {
+            bool plan, zeroCopy;
+            size_t threads;
+        } configs[] = { { false, false, 1 }, { true, false, 1 }, { true, true, 1 }, { true, true, 3 } };
+
+        Vectors control[2];
+        for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); ++c)
+        {
+            Network network;
+            network.SetMemoryPlan(configs[c].plan);
+            network.SetZeroCopy(configs[c].zeroCopy);
+            TEST_CHECK(network.Load("memory_plan.xml", "memory_plan.bin"));
+            network.SetThreadNumber(configs[c].threads, 1);
+            for (unsigned s = 0; s < 2; ++s)
+            {
+                Vectors dst;
+                Forward(network, s, dst);
+                if (c == 0)
+                    control[s] = dst;
+                else
+                    TEST_CHECK(Equal(control[s], dst, 1e-5f));
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,218 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "TestUnit.h"
+
+#include "Synet/Converters/Optimizer.h"
+
+namespace Test
+{
+    inline Strings LayerNames(const Synet::NetworkParam & network)
+    {
+        Strings names;
+        for (size_t i = 0; i < network.layers().size(); ++i)
+            names.push_back(network.layers()[i].name());
+        return names;
+    }
+
+    inline bool OptimizerTest(UnitModel & model, const String & name, const std::vector<Synet::LayerType> & types)
+    {
+        TEST_CHECK(model.Save(name));
+        Synet::Optimizer optimizer;
+        TEST_CHECK(optimizer.Run(model.Param(), model.Weight()));
+        TEST_CHECK(model.Param().layers().size() == types.size());
+        for (size_t i = 0; i < types.size(); ++i)
+            TEST_CHECK(model.Param().layers()[i].type() == types[i]);
+        TEST_CHECK(model.Save(name + "_optimized"));
+
+        Network original, optimized;
+        TEST_CHECK(original.Load(name + ".xml", name + ".bin"));
+        TEST_CHECK(optimized.Load(name + "_optimized.xml", name + "_optimized.bin"));
+        for (unsigned s = 0; s < 2; ++s)
+        {
+            Vectors control, dst;
+            Forward(original, s, control);
+            Forward(optimized, s, dst);
+            TEST_CHECK(Equal(control, dst, 1e-4f));
+        }
+        return true;
+    }
+
+    inline bool GraphRewriterTest()
+    {
+        typedef Synet::GraphRewriter GraphRewriter;
+        Strings inputs;
+        GraphRewriter::Rewrite skipRelu = [&inputs](const GraphRewriter::Match & match, GraphRewriter::Layers & dst)
+        {
+            inputs = match.inputs;
+            GraphRewriter::Layer layer = match.Root();
+            layer.param.src() = match.inputs;
+            dst.push_back(layer);
+            return true;
+        };
+        GraphRewriter chain, residual;
+        {
+            GraphRewriter::Pattern pattern("SkipRelu", skipRelu);
+            int relu = pattern.Add(Synet::LayerTypeRelu, Synet::Ints({ -1 }));
+            pattern.Add(Synet::LayerTypeSigmoid, Synet::Ints({ relu }));
+            chain.Add(pattern);
+        }
+        {
+            GraphRewriter::Pattern pattern("SkipRelu", skipRelu);
+            int relu = pattern.Add(Synet::LayerTypeRelu, Synet::Ints({ -1 }));
+            pattern.Add(Synet::LayerTypeEltwise, Synet::Ints({ relu, -2 }), GraphRewriter::Predicate(), true);
+            residual.Add(pattern);
+        }
+        GraphRewriter::Tensors weight;
+
+        UnitModel simple;
+        simple.Input("data", Shape({ 1, 4 }));
+        simple.Add(Synet::LayerTypeRelu, "relu", Strings({ "data" }));
+        simple.Add(Synet::LayerTypeSigmoid, "sigmoid", Strings({ "relu" }));
+        simple.Add(Synet::LayerTypeSigmoid, "tail", Strings({ "sigmoid" }));
+        TEST_CHECK(chain.Run(simple.Param(), weight));
+        TEST_CHECK(LayerNames(simple.Param()) == Strings({ "data", "sigmoid", "tail" }));
+        TEST_CHECK(simple.Param().layers()[1].src() == Strings({ "data" }));
+        TEST_CHECK(inputs == Strings({ "data" }));
+
+        UnitModel shared;
+        shared.Input("data", Shape({ 1, 4 }));
+        shared.Add(Synet::LayerTypeRelu, "relu", Strings({ "data" }));
+        shared.Add(Synet::LayerTypeSigmoid, "sigmoid", Strings({ "relu" }));
+        shared.Add(Synet::LayerTypeEltwise, "sum", Strings({ "sigmoid", "relu" }));
+        TEST_CHECK(chain.Run(shared.Param(), weight));
+        TEST_CHECK(LayerNames(shared.Param()) == Strings({ "data", "relu", "sigmoid", "sum" }));
+
+        UnitModel output;
+        output.Input("data", Shape({ 1, 4 }));
+        output.Add(Synet::LayerTypeRelu, "relu", Strings({ "data" }));
+        output.Add(Synet::LayerTypeSigmoid, "sigmoid", Strings({ "relu" }));
+        output.Param().dst() = Strings({ "relu", "sigmoid" });
+        TEST_CHECK(chain.Run(output.Param(), weight));
+        TEST_CHECK(LayerNames(output.Param()) == Strings({ "data", "relu", "sigmoid" }));
+
+        UnitModel swapped;
+        swapped.Input("data", Shape({ 1, 4 }));
+        swapped.Input("other", Shape({ 1, 4 }));
+        swapped.Add(Synet::LayerTypeRelu, "relu", Strings({ "data" }));
+        swapped.Add(Synet::LayerTypeEltwise, "sum", Strings({ "other", "relu" }));
+        TEST_CHECK(residual.Run(swapped.Param(), weight));
+        TEST_CHECK(LayerNames(swapped.Param()) == Strings({ "data", "other", "sum" }));
+        TEST_CHECK(inputs == Strings({ "data", "other" }));
+
+        UnitModel fallback;
+        fallback.Input("data", Shape({ 1, 4 }));
+        fallback.Input("other", Shape({ 1, 4 }));
+        fallback.Add(Synet::LayerTypeRelu, "shared", Strings({ "data" }));
+        fallback.Add(Synet::LayerTypeRelu, "relu", Strings({ "other" }));
+        fallback.Add(Synet::LayerTypeEltwise, "sum", Strings({ "shared", "relu" }));
+        fallback.Add(Synet::LayerTypeSigmoid, "tail", Strings({ "shared" }));
+        TEST_CHECK(residual.Run(fallback.Param(), weight));
+        TEST_CHECK(LayerNames(fallback.Param()) == Strings({ "data", "other", "shared", "sum", "tail" }));
+        TEST_CHECK(inputs == Strings({ "other", "shared" }));
+        return true;
+    }
+
+    inline bool FoldAffineTest()
+    {
+        UnitModel model(1);
+        model.Input("data", Shape({ 1, 8, 6, 6 }));
+        model.Convolution("conv", "data", 8, 8, 3);
+        Synet::LayerParam & batchNorm = model.Add(Synet::LayerTypeBatchNorm, "batchNorm", Strings({ "conv" }));
+        model.Weight(batchNorm, Shape({ 8 }));
+        model.Weight(batchNorm, Shape({ 8 }), 0.5f, 2.0f);
+        model.Weight(batchNorm, Shape({ 1 }), 0.5f, 2.0f);
+        Synet::LayerParam & scale = model.Add(Synet::LayerTypeScale, "scale", Strings({ "batchNorm" }));
+        scale.scale().biasTerm() = true;
+        model.Weight(scale, Shape({ 8 }));
+        model.Weight(scale, Shape({ 8 }));
+        model.Weight(model.Add(Synet::LayerTypeBias, "bias", Strings({ "scale" })), Shape({ 8 }));
+        model.Convolution("unbiased", "bias", 8, 4, 1, 1, false);
+        model.Weight(model.Add(Synet::LayerTypeBias, "shift", Strings({ "unbiased" })), Shape({ 4 }));
+        Synet::LayerParam & product = model.Add(Synet::LayerTypeInnerProduct, "product", Strings({ "shift" }));
+        product.innerProduct().outputNum() = 10;
+        model.Weight(product, Shape({ 10, 144 }));
+        model.Weight(product, Shape({ 10 }));
+        model.Weight(model.Add(Synet::LayerTypeScale, "product_scale", Strings({ "product" })), Shape({ 10 }));
+        return OptimizerTest(model, "fold_affine", { Synet::LayerTypeInput, Synet::LayerTypeConvolution, 
+            Synet::LayerTypeConvolution, Synet::LayerTypeInnerProduct });
+    }
+
+    inline bool ConvolutionResidualTest()
+    {
+        UnitModel model(2);
+        model.Input("data", Shape({ 1, 8, 10, 10 }));
+        model.Convolution("a", "data", 8, 8, 3);
+        model.Convolution("b", "a", 8, 8, 1);
+        model.Add(Synet::LayerTypeEltwise, "c", Strings({ "a", "b" }));
+        model.Add(Synet::LayerTypeRelu, "d", Strings({ "c" })).relu().negativeSlope() = 0.1f;
+        model.Convolution("e", "d", 8, 8, 3);
+        model.Add(Synet::LayerTypeShortcut, "f", Strings({ "e", "d" }));
+        TEST_CHECK(OptimizerTest(model, "convolution_residual", { Synet::LayerTypeInput, Synet::LayerTypeConvolution, 
+            Synet::LayerTypeConvolution, Synet::LayerTypeConvolution }));
+        const Synet::NetworkParam & network = model.Param();
+        TEST_CHECK(!network.layers()[1].convolution().residual());
+        TEST_CHECK(network.layers()[2].convolution().residual() && network.layers()[2].src() == Strings({ "a", "a" }));
+        TEST_CHECK(network.layers()[2].convolution().activationType() == Synet::ActivationFunctionTypeLeakyRelu);
+        TEST_CHECK(network.layers()[3].convolution().residual() && network.layers()[3].src() == Strings({ "d", "d" }));
+        return true;
+    }
+
+    inline bool PointwiseTest()
+    {
+        UnitModel chain(3);
+        chain.Input("data", Shape({ 1, 8, 6, 6 }));
+        Synet::LayerParam & scale = chain.Add(Synet::LayerTypeScale, "scale", Strings({ "data" }));
+        scale.scale().biasTerm() = true;
+        chain.Weight(scale, Shape({ 8 }));
+        chain.Weight(scale, Shape({ 8 }));
+        chain.Add(Synet::LayerTypeRelu, "relu", Strings({ "scale" })).relu().negativeSlope() = 0.1f;
+        chain.Add(Synet::LayerTypeSigmoid, "sigmoid", Strings({ "relu" }));
+        chain.Add(Synet::LayerTypeEltwise, "sum", Strings({ "sigmoid", "data" })).eltwise().coefficients() = Synet::Floats({ 1.0f, 0.5f });
+        chain.Add(Synet::LayerTypeUnaryOperation, "neg", Strings({ "sum" })).unaryOperation().type() = Synet::UnaryOperationTypeNeg;
+        Synet::LayerParam & range = chain.Add(Synet::LayerTypeRestrictRange, "range", Strings({ "neg" }));
+        range.restrictRange().lower() = -0.5f;
+        range.restrictRange().upper() = 0.5f;
+        chain.Weight(chain.Add(Synet::LayerTypeBias, "bias", Strings({ "range" })), Shape({ 8 }));
+        TEST_CHECK(OptimizerTest(chain, "pointwise_chain", { Synet::LayerTypeInput, Synet::LayerTypePointwise }));
+
+        UnitModel constant(4);
+        constant.Input("data", Shape({ 1, 1, 1, 32 }));
+        constant.Weight(constant.Add(Synet::LayerTypeConst, "c0", Strings()), Shape({ 1, 1, 1, 1 }), 1.0f, 2.0f);
+        constant.Add(Synet::LayerTypeBinaryOperation, "div", Strings({ "data", "c0" })).binaryOperation().type() = Synet::BinaryOperationTypeDiv;
+        constant.Weight(constant.Add(Synet::LayerTypeConst, "c1", Strings()), Shape({ 1, 1, 1, 1 }));
+        constant.Add(Synet::LayerTypeBinaryOperation, "sub", Strings({ "c1", "div" })).binaryOperation().type() = Synet::BinaryOperationTypeSub;
+        constant.Weight(constant.Add(Synet::LayerTypeConst, "c2", Strings()), Shape({ 1, 1, 1, 1 }));
+        constant.Add(Synet::LayerTypeBinaryOperation, "sub2", Strings({ "sub", "c2" })).binaryOperation().type() = Synet::BinaryOperationTypeSub;
+        constant.Add(Synet::LayerTypeSigmoid, "sigmoid", Strings({ "sub2" }));
+        constant.Weight(constant.Add(Synet::LayerTypeConst, "c3", Strings()), Shape({ 1, 1, 1, 1 }));
+        constant.Add(Synet::LayerTypeBinaryOperation, "inverse", Strings({ "c3", "sigmoid" })).binaryOperation().type() = Synet::BinaryOperationTypeDiv;
+        TEST_CHECK(OptimizerTest(constant, "pointwise_constant", { Synet::LayerTypeInput, Synet::LayerTypePointwise, 
+            Synet::LayerTypeConst, Synet::LayerTypeBinaryOperation }));
+        return true;
+    }
+}
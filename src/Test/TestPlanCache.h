@@ -0,0 +1,77 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "TestUnit.h"
+
+namespace Test
+{
+    inline bool PlanCacheTest()
+    {
+        UnitModel model(7);
+        model.Input("data", Shape({ 1, 8, 12, 12 }));
+        model.Convolution("a", "data", 8, 16, 3);
+        model.Add(Synet::LayerTypeRelu, "b", Strings({ "a" }));
+        model.Convolution("c", "b", 16, 16, 3);
+        model.Add(Synet::LayerTypeEltwise, "d", Strings({ "b", "c" }));
+        model.Add(Synet::LayerTypeSigmoid, "d", Strings({ "d" }), Strings({ "d" }));
+        TEST_CHECK(model.Save("plan_cache"));
+
+        const Shape shapes[] = { Shape({ 1, 8, 12, 12 }), Shape({ 1, 8, 7, 9 }), Shape({ 1, 8, 12, 12 }), 
+            Shape({ 1, 8, 7, 9 }), Shape({ 2, 8, 5, 5 }), Shape({ 1, 8, 12, 12 }) };
+        const size_t count = sizeof(shapes) / sizeof(shapes[0]);
+        Vectors control[count];
+        for (size_t i = 0; i < count; ++i)
+        {
+            Network network;
+            TEST_CHECK(network.Load("plan_cache.xml", "plan_cache.bin"));
+            TEST_CHECK(network.Reshape(Strings({ "data" }), Synet::Shapes({ shapes[i] })));
+            Forward(network, (unsigned)i, control[i]);
+        }
+
+        const size_t caches[] = { 1, 1 << 30 };
+        for (size_t c = 0; c < sizeof(caches) / sizeof(caches[0]); ++c)
+        {
+            Network network;
+            network.SetPlanCache(caches[c]);
+            TEST_CHECK(network.Load("plan_cache.xml", "plan_cache.bin"));
+            const Tensor * first = NULL;
+            for (size_t i = 0; i < count; ++i)
+            {
+                TEST_CHECK(network.Reshape(Strings({ "data" }), Synet::Shapes({ shapes[i] })));
+                TEST_CHECK(network.Src()[0]->Shape() == shapes[i]);
+                if (i == 0)
+                    first = network.Dst()[0];
+                else if (shapes[i] == shapes[0] && caches[c] > 1)
+                    TEST_CHECK(network.Dst()[0] == first);
+                Vectors dst;
+                Forward(network, (unsigned)i, dst);
+                TEST_CHECK(Equal(control[i], dst, 0.0f));
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,65 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "TestUnit.h"
+#include "TestBinaryParam.h"
+#include "TestConvolution.h"
+#include "TestGemm.h"
+#include "TestMemoryPlan.h"
+#include "TestOptimizer.h"
+#include "TestPlanCache.h"
+#include "TestWeightMapping.h"
+
+int main(int argc, char* argv[])
+{
+    struct Unit
+    {
+        const char * name;
+        bool(*test)();
+    } const units[] = {
+        { "BinaryParam", Test::BinaryParamTest },
+        { "Convolution", Test::ConvolutionTest },
+        { "ConvolutionResidual", Test::ConvolutionResidualTest },
+        { "FoldAffine", Test::FoldAffineTest },
+        { "Gemm", Test::GemmTest },
+        { "GraphRewriter", Test::GraphRewriterTest },
+        { "MemoryPlan", Test::MemoryPlanTest },
+        { "Pointwise", Test::PointwiseTest },
+        { "PlanCache", Test::PlanCacheTest },
+        { "WeightMapping", Test::WeightMappingTest },
+    };
+
+    Test::String filter = argc > 1 ? argv[1] : "";
+    size_t failed = 0;
+    for (size_t i = 0; i < sizeof(units) / sizeof(units[0]); ++i)
+    {
+        if (Test::String(units[i].name).find(filter) == Test::String::npos)
+            continue;
+        bool result = units[i].test();
+        std::cout << units[i].name << (result ? " is OK." : " is FAILED!") << std::endl;
+        failed += result ? 0 : 1;
+    }
+    return failed ? 1 : 0;
+}
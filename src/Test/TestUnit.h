@@ -0,0 +1,157 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Synet/Synet.h"
+
+#include <random>
+
+#define TEST_CHECK(condition) \
+    if (!(condition)) \
+    { \
+        std::cout << __FILE__ << "(" << __LINE__ << "): check '" << #condition << "' is failed!" << std::endl; \
+        return false; \
+    }
+
+namespace Test
+{
+    typedef Synet::String String;
+    typedef Synet::Strings Strings;
+    typedef Synet::Shape Shape;
+    typedef Synet::Tensor<float> Tensor;
+    typedef std::vector<Tensor> Tensors;
+    typedef Synet::Network<float> Network;
+    typedef std::vector<float> Vector;
+    typedef std::vector<Vector> Vectors;
+
+    inline void FillRandom(float * data, size_t size, unsigned seed, float lo = -1.0f, float hi = 1.0f)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> distribution(lo, hi);
+        for (size_t i = 0; i < size; ++i)
+            data[i] = distribution(random);
+    }
+
+    inline bool Equal(const float * a, const float * b, size_t size, float eps)
+    {
+        for (size_t i = 0; i < size; ++i)
+            if (::fabs(a[i] - b[i]) > eps * (1.0f + ::fabs(a[i])))
+                return false;
+        return true;
+    }
+
+    inline bool Equal(const Vectors & a, const Vectors & b, float eps)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); ++i)
+            if (a[i].size() != b[i].size() || !Equal(a[i].data(), b[i].data(), a[i].size(), eps))
+                return false;
+        return true;
+    }
+
+    class UnitModel
+    {
+    public:
+        UnitModel(unsigned seed = 0)
+            : _seed(seed)
+        {
+            _param().name() = "unit";
+        }
+
+        Synet::LayerParam & Add(Synet::LayerType type, const String & name, const Strings & src, const Strings & dst = Strings())
+        {
+            _param().layers().push_back(Synet::LayerParam());
+            Synet::LayerParam & layer = _param().layers().back();
+            layer.type() = type;
+            layer.name() = name;
+            layer.src() = src;
+            layer.dst() = dst.empty() ? Strings(1, name) : dst;
+            return layer;
+        }
+
+        Synet::LayerParam & Input(const String & name, const Shape & shape, Synet::TensorFormat format = Synet::TensorFormatNchw)
+        {
+            Synet::LayerParam & layer = Add(Synet::LayerTypeInput, name, Strings());
+            layer.input().shape().resize(1);
+            layer.input().shape()[0].dim() = shape;
+            layer.input().shape()[0].format() = format;
+            return layer;
+        }
+
+        Synet::LayerParam & Convolution(const String & name, const String & src, size_t srcC, size_t dstC, size_t kernel, size_t group = 1, bool bias = true)
+        {
+            Synet::LayerParam & layer = Add(Synet::LayerTypeConvolution, name, Strings(1, src));
+            layer.convolution().outputNum() = (uint32_t)dstC;
+            layer.convolution().group() = (uint32_t)group;
+            layer.convolution().biasTerm() = bias;
+            layer.convolution().kernel() = Shape({ kernel, kernel });
+            layer.convolution().pad() = Shape({ kernel / 2, kernel / 2, kernel / 2, kernel / 2 });
+            Weight(layer, Shape({ dstC, srcC / group, kernel, kernel }));
+            if (bias)
+                Weight(layer, Shape({ dstC }));
+            return layer;
+        }
+
+        void Weight(Synet::LayerParam & layer, const Shape & shape, float lo = -1.0f, float hi = 1.0f)
+        {
+            layer.weight().push_back(Synet::ShapeParam());
+            layer.weight().back().dim() = shape;
+            _weight.push_back(Tensor(shape));
+            FillRandom(_weight.back().CpuData(), _weight.back().Size(), _seed++, lo, hi);
+        }
+
+        Synet::NetworkParam & Param()
+        {
+            return _param();
+        }
+
+        Tensors & Weight()
+        {
+            return _weight;
+        }
+
+        bool Save(const String & name, size_t alignment = SYNET_WEIGHT_ALIGNMENT) const
+        {
+            return _param.Save(name + ".xml", false) && Synet::SaveWeight(_weight, name + ".bin", alignment);
+        }
+
+    private:
+        Synet::NetworkParamHolder _param;
+        Tensors _weight;
+        unsigned _seed;
+    };
+
+    inline void Forward(Network & network, unsigned seed, Vectors & dst)
+    {
+        for (size_t i = 0; i < network.Src().size(); ++i)
+            FillRandom(network.Src()[i]->CpuData(), network.Src()[i]->Size(), seed + (unsigned)i);
+        network.Forward();
+        dst.clear();
+        for (size_t i = 0; i < network.Dst().size(); ++i)
+            dst.push_back(Vector(network.Dst()[i]->CpuData(), network.Dst()[i]->CpuData() + network.Dst()[i]->Size()));
+    }
+}
@@ -0,0 +1,100 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2018 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "TestUnit.h"
+
+#include <fstream>
+
+namespace Test
+{
+    inline bool CorruptFile(const String & src, const String & dst, size_t cut, size_t position, char value)
+    {
+        std::ifstream ifs(src.c_str(), std::ifstream::binary);
+        String data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        if (data.size() < cut + position + 1)
+            return false;
+        data.resize(data.size() - cut);
+        data[position] = value;
+        std::ofstream ofs(dst.c_str(), std::ofstream::binary);
+        ofs.write(data.data(), data.size());
+        return (bool)ofs;
+    }
+
+    inline bool WeightMappingTest()
+    {
+        UnitModel model(6);
+        model.Input("data", Shape({ 1, 8, 6, 6 }));
+        model.Convolution("conv", "data", 8, 8, 3);
+        Synet::LayerParam & scale = model.Add(Synet::LayerTypeScale, "scale", Strings({ "conv" }));
+        scale.scale().biasTerm() = true;
+        model.Weight(scale, Shape({ 8 }));
+        model.Weight(scale, Shape({ 8 }));
+        model.Weight(model.Add(Synet::LayerTypeConst, "const", Strings()), Shape({ 1, 8, 6, 6 }));
+        model.Add(Synet::LayerTypeSigmoid, "sigmoid", Strings({ "const" }), Strings({ "const" }));
+        model.Add(Synet::LayerTypeEltwise, "sum", Strings({ "scale", "const" }));
+        Synet::LayerParam & product = model.Add(Synet::LayerTypeInnerProduct, "product", Strings({ "sum" }));
+        product.innerProduct().outputNum() = 7;
+        model.Weight(product, Shape({ 7, 288 }));
+        model.Weight(product, Shape({ 7 }));
+
+        const size_t alignments[] = { 0, 4, 64, 4096 };
+        Vectors control;
+        for (size_t a = 0; a < sizeof(alignments) / sizeof(alignments[0]); ++a)
+        {
+            std::stringstream name;
+            name << "weight_mapping_" << alignments[a];
+            TEST_CHECK(model.Save(name.str(), alignments[a]));
+            for (int mapping = 0; mapping < 2; ++mapping)
+            {
+                Network network;
+                network.SetWeightMapping(mapping != 0);
+                TEST_CHECK(network.Load(name.str() + ".xml", name.str() + ".bin"));
+                for (size_t i = 0; i < 2; ++i)
+                {
+                    Vectors dst;
+                    Forward(network, 1, dst);
+                    if (control.empty())
+                        control = dst;
+                    else
+                        TEST_CHECK(Equal(control, dst, 0.0f));
+                }
+            }
+        }
+
+        TEST_CHECK(CorruptFile("weight_mapping_64.bin", "weight_mapping_version.bin", 0, 8, 2));
+        TEST_CHECK(CorruptFile("weight_mapping_64.bin", "weight_mapping_truncated.bin", 4, 0, 'S'));
+        for (int mapping = 0; mapping < 2; ++mapping)
+        {
+            Network version, truncated;
+            version.SetWeightMapping(mapping != 0);
+            truncated.SetWeightMapping(mapping != 0);
+            TEST_CHECK(!version.Load("weight_mapping_64.xml", "weight_mapping_version.bin"));
+            TEST_CHECK(!truncated.Load("weight_mapping_64.xml", "weight_mapping_truncated.bin"));
+        }
+        return true;
+    }
+}